@@ -0,0 +1,131 @@
+/**
+ * ----------------------------------------------------------------------------
+ * bench_alarm.c
+ * Description: Host benchmark for the priority transmit queue. Bulk dumps
+ * are sent with UART_putString on a simulated 9600 baud UART while an
+ * "interrupt" queues a high priority alarm at random times, and the worst
+ * case alarm latency is read back from the trace statistics. Fails if an
+ * alarm waited longer than one bulk frame plus the character on the wire.
+ * The bound assumes the application is inside the driver (UART_putString)
+ * the whole time, alarms are only sent while the queue is being serviced.
+ * ----------------------------------------------------------------------------
+ */
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../inc/UART_driver.h"
+#include "../inc/UART_backend.h"
+#include "../inc/UART_trace.h"
+#include "../inc/UART_txqueue.h"
+#include "test_util.h"
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+// Simulated line rate, 10 bits (start, 8 data, stop) per character
+#define BENCH_BAUD 9600
+#define BENCH_CHAR_CYCLES ((UART_TRACE_CLOCK_HZ * 10) / BENCH_BAUD)
+// Cycles one pass of the driver's polling loop takes
+#define BENCH_POLL_CYCLES 100
+// Alarms to send, and the range of time between them
+#define BENCH_ALARMS 2000
+#define BENCH_ALARM_MIN_CYCLES (UART_TRACE_CLOCK_HZ / 50)
+#define BENCH_ALARM_SPREAD_CYCLES (UART_TRACE_CLOCK_HZ / 5)
+// Length of each bulk dump
+#define BENCH_DUMP_LEN 4096
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Global variables
+// Cycle count when the character being sent has left the transmitter
+uint32_t g_bench_busy_until = 0;
+uint32_t g_bench_next_alarm = 0;
+uint32_t g_bench_alarms = 0;
+UART_backend_t g_bench_backend;
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+//=============================================================================
+// Simulated UART transmitter. Every poll takes BENCH_POLL_CYCLES and is where the alarm "interrupt" may fire.
+static uint32_t bench_txReady()
+{
+    UART_trace_simAdvance(BENCH_POLL_CYCLES);
+
+    // Alarm interrupt, queued the way an interrupt handler would
+    if((g_bench_alarms < BENCH_ALARMS) && ((int32_t) (UART_trace_now() - g_bench_next_alarm) >= 0))
+    {
+        if(UART_txQueue("ALARM\r\n", 7, UART_PRIO_HIGH))
+        {
+            g_bench_alarms++;
+        }
+        g_bench_next_alarm = UART_trace_now() + BENCH_ALARM_MIN_CYCLES + (test_random() % BENCH_ALARM_SPREAD_CYCLES);
+    }
+
+    return (int32_t) (UART_trace_now() - g_bench_busy_until) >= 0;
+}
+static void bench_write(char c)
+{
+    (void) c;
+    g_bench_busy_until = UART_trace_now() + BENCH_CHAR_CYCLES;
+}
+static uint32_t bench_txDone()
+{
+    return bench_txReady();
+}
+//=============================================================================
+// Prints the statistics of one channel in milliseconds.
+static void bench_print(const char *name, UART_latency_t *stats)
+{
+    printf("%-12s n=%u min=%.2fms avg=%.2fms p99=%.2fms max=%.2fms\n", name, stats->count,
+           stats->min * 1000.0 / UART_TRACE_CLOCK_HZ, stats->avg * 1000.0 / UART_TRACE_CLOCK_HZ,
+           stats->p99 * 1000.0 / UART_TRACE_CLOCK_HZ, stats->max * 1000.0 / UART_TRACE_CLOCK_HZ);
+}
+//=============================================================================
+// Main Function
+int main(void)
+{
+    //-----------------------------------------------------------------------------
+    static char dump[BENCH_DUMP_LEN + 1];
+    UART_latency_t high;
+    UART_latency_t bulk;
+    uint32_t bound = (UART_TX_FRAME_MAX + 1) * BENCH_CHAR_CYCLES;
+    uint32_t i = 0;
+    //-----------------------------------------------------------------------------
+
+    for(i = 0; i < BENCH_DUMP_LEN; i++)
+    {
+        dump[i] = 'a' + (i % 26);
+    }
+    dump[BENCH_DUMP_LEN] = '\0';
+
+    g_bench_backend = test_backend_noop();
+    g_bench_backend.txReady = bench_txReady;
+    g_bench_backend.write = bench_write;
+    g_bench_backend.txDone = bench_txDone;
+    UART_setBackend(&g_bench_backend);
+    UART_init(UART_base_0);
+    UART_trace_init();
+    g_bench_next_alarm = BENCH_ALARM_MIN_CYCLES;
+
+    // Saturating bulk load, the transmitter never runs out of bulk data while alarms are raised
+    while(g_bench_alarms < BENCH_ALARMS)
+    {
+        UART_putString(dump);
+    }
+    UART_txFlush();
+
+    UART_trace_getStats(UART_TRACE_TX_HIGH, &high);
+    UART_trace_getStats(UART_TRACE_TX_BULK, &bulk);
+    printf("%d baud, %d byte frames, bound %.2fms (application always inside UART_putString)\n", BENCH_BAUD, UART_TX_FRAME_MAX, bound * 1000.0 / UART_TRACE_CLOCK_HZ);
+    bench_print("alarm (high)", &high);
+    bench_print("bulk", &bulk);
+
+    UART_reset();
+
+    if((high.count != BENCH_ALARMS) || (high.max > bound))
+    {
+        printf("bench_alarm: alarm latency above bound\n");
+        return 1;
+    }
+    return 0;
+}
+//=============================================================================
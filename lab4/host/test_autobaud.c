@@ -0,0 +1,199 @@
+/**
+ * ----------------------------------------------------------------------------
+ * test_autobaud.c
+ * Description: Host test for the auto-baud divisor computation. Edge
+ * timestamps of a sync character (0x55) are simulated for a range of baud
+ * rates with polling jitter, and the divisors computed from them are checked,
+ * as well as rates and edge patterns that must be rejected.
+ * ----------------------------------------------------------------------------
+ */
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Includes
+#include <stdio.h>
+
+#include "../inc/UART_autobaud.h"
+#include "../inc/UART_trace.h"
+#include "test_util.h"
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+// Polling jitter added to every edge, in cycles (a few passes of the polling loop)
+#define TEST_JITTER_CYCLES 20
+// Simulated sync characters per rate
+#define TEST_TRIALS 200
+
+//=============================================================================
+// Simulates the edges of one 0x55 at a baud rate, starting at cycle start (wrapping is allowed), each edge seen up to TEST_JITTER_CYCLES late.
+static void simulate_sync(uint32_t baud, uint32_t start, uint32_t *edges)
+{
+    //-----------------------------------------------------------------------------
+    uint32_t i = 0;
+    //-----------------------------------------------------------------------------
+
+    for(i = 0; i < UART_AUTOBAUD_EDGES; i++)
+    {
+        edges[i] = start + (uint32_t) (((uint64_t) i * UART_TRACE_CLOCK_HZ) / baud) + (test_random() % TEST_JITTER_CYCLES);
+    }
+}
+//=============================================================================
+// Returns the baud rate the divisors actually give, times 100.
+static uint32_t divisor_rate_x100(uint32_t ibrd, uint32_t fbrd)
+{
+    // baud = clock / (16 * (ibrd + fbrd / 64)) = clock * 4 / (ibrd * 64 + fbrd)
+    return (uint32_t) (((uint64_t) UART_TRACE_CLOCK_HZ * 400) / ((ibrd * 64) + fbrd));
+}
+//=============================================================================
+// Checks that every simulated sync character at a standard rate gives exactly that rate and its divisors.
+static void check_standard(uint32_t baud)
+{
+    //-----------------------------------------------------------------------------
+    uint32_t edges[UART_AUTOBAUD_EDGES];
+    uint32_t divisor = ((UART_TRACE_CLOCK_HZ * 4) + (baud / 2)) / baud;
+    uint32_t ibrd = 0;
+    uint32_t fbrd = 0;
+    uint32_t trial = 0;
+    uint32_t ok = 0;
+    //-----------------------------------------------------------------------------
+
+    for(trial = 0; trial < TEST_TRIALS; trial++)
+    {
+        simulate_sync(baud, test_random() << 8, edges);
+        if((UART_autoBaudCompute(edges, &ibrd, &fbrd) == baud) && (ibrd == divisor / 64) && (fbrd == divisor % 64))
+        {
+            ok++;
+        }
+    }
+    if(ok != TEST_TRIALS)
+    {
+        printf("%u baud: %u of %u sync characters computed correctly\n", baud, ok, TEST_TRIALS);
+    }
+    CHECK(ok == TEST_TRIALS);
+}
+//=============================================================================
+// Checks that a non-standard rate is measured, and programmed, within 2% (the jitter is up to 1.3% of the 9 bit span at 100000 baud).
+static void check_measured(uint32_t baud)
+{
+    //-----------------------------------------------------------------------------
+    uint32_t edges[UART_AUTOBAUD_EDGES];
+    uint32_t ibrd = 0;
+    uint32_t fbrd = 0;
+    uint32_t measured = 0;
+    uint32_t trial = 0;
+    uint32_t ok = 0;
+    //-----------------------------------------------------------------------------
+
+    for(trial = 0; trial < TEST_TRIALS; trial++)
+    {
+        simulate_sync(baud, test_random() << 8, edges);
+        measured = UART_autoBaudCompute(edges, &ibrd, &fbrd);
+        if((measured * 100 >= baud * 98) && (measured * 100 <= baud * 102) &&
+           (divisor_rate_x100(ibrd, fbrd) >= baud * 98) && (divisor_rate_x100(ibrd, fbrd) <= baud * 102))
+        {
+            ok++;
+        }
+    }
+    if(ok != TEST_TRIALS)
+    {
+        printf("%u baud: %u of %u sync characters within 2%%\n", baud, ok, TEST_TRIALS);
+    }
+    CHECK(ok == TEST_TRIALS);
+}
+//=============================================================================
+// Checks that a rate is always rejected.
+static void check_rejected(uint32_t baud)
+{
+    //-----------------------------------------------------------------------------
+    uint32_t edges[UART_AUTOBAUD_EDGES];
+    uint32_t ibrd = 0;
+    uint32_t fbrd = 0;
+    uint32_t trial = 0;
+    uint32_t ok = 0;
+    //-----------------------------------------------------------------------------
+
+    for(trial = 0; trial < TEST_TRIALS; trial++)
+    {
+        simulate_sync(baud, test_random() << 8, edges);
+        if(UART_autoBaudCompute(edges, &ibrd, &fbrd) == 0)
+        {
+            ok++;
+        }
+    }
+    CHECK(ok == TEST_TRIALS);
+}
+//=============================================================================
+// Main Function
+int main(void)
+{
+    //-----------------------------------------------------------------------------
+    const uint32_t standard[] = {1200, 2400, 4800, 9600, 19200, 38400, 57600, 115200, 230400};
+    const uint32_t other[] = {300, 14400, 28800, 100000};
+    uint32_t edges[UART_AUTOBAUD_EDGES];
+    uint32_t ibrd = 0;
+    uint32_t fbrd = 0;
+    uint32_t bit = UART_TRACE_CLOCK_HZ / 9600;
+    uint32_t i = 0;
+    //-----------------------------------------------------------------------------
+
+    //-----------------------------------------------------------------------------
+    /* 9600 baud gives the divisors UART_init uses */
+    for(i = 0; i < UART_AUTOBAUD_EDGES; i++)
+    {
+        edges[i] = 1000 + (uint32_t) (((uint64_t) i * UART_TRACE_CLOCK_HZ) / 9600);
+    }
+    CHECK(UART_autoBaudCompute(edges, &ibrd, &fbrd) == 9600);
+    CHECK((ibrd == 104) && (fbrd == 11));
+
+    //-----------------------------------------------------------------------------
+    /* 300 to 230400 baud with polling jitter */
+    for(i = 0; i < sizeof(standard) / sizeof(standard[0]); i++)
+    {
+        check_standard(standard[i]);
+    }
+    for(i = 0; i < sizeof(other) / sizeof(other[0]); i++)
+    {
+        check_measured(other[i]);
+    }
+
+    //-----------------------------------------------------------------------------
+    /* Too fast for the polling loop, or too slow */
+    check_rejected(460800);
+    check_rejected(921600);
+    check_rejected(150);
+
+    //-----------------------------------------------------------------------------
+    /* Edge patterns that are not 0x55 */
+    // 0xF0 (start, 0000, 1111, stop): a 5 bit low period and 4 bit high period, with the remaining edges from the following character
+    edges[0] = 0;
+    edges[1] = 5 * bit;
+    for(i = 2; i < UART_AUTOBAUD_EDGES; i++)
+    {
+        edges[i] = edges[i - 1] + ((i % 2) ? (4 * bit) : (bit / 2));
+    }
+    CHECK(UART_autoBaudCompute(edges, &ibrd, &fbrd) == 0);
+
+    // 0x55 with a glitch: one bit twice as long and the next one missing its edge
+    for(i = 0; i < UART_AUTOBAUD_EDGES; i++)
+    {
+        edges[i] = i * bit;
+    }
+    edges[4] = edges[3] + (2 * bit);
+    edges[5] = edges[4] + (bit / 4);
+    CHECK(UART_autoBaudCompute(edges, &ibrd, &fbrd) == 0);
+
+    // One bit 30% short, outside the 25% tolerance
+    for(i = 0; i < UART_AUTOBAUD_EDGES; i++)
+    {
+        edges[i] = i * bit;
+    }
+    edges[6] = edges[5] + ((bit * 7) / 10);
+    CHECK(UART_autoBaudCompute(edges, &ibrd, &fbrd) == 0);
+
+    if(g_failures != 0)
+    {
+        printf("test_autobaud: %d check(s) failed\n", g_failures);
+        return 1;
+    }
+    printf("test_autobaud: all checks passed\n");
+    return 0;
+}
+//=============================================================================
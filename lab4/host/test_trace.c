@@ -0,0 +1,190 @@
+/**
+ * ----------------------------------------------------------------------------
+ * test_trace.c
+ * Description: Host test for the receive latency tracing. Known samples are
+ * produced with the simulated cycle counter and the min/avg/p99/max read
+ * back are checked, also through the stamped receive path and the transmit
+ * queue on a fake backend.
+ * ----------------------------------------------------------------------------
+ */
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Includes
+#include <stdio.h>
+
+#include "../inc/UART_driver.h"
+#include "../inc/UART_backend.h"
+#include "../inc/UART_trace.h"
+#include "../inc/UART_txqueue.h"
+#include "test_util.h"
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Global variables
+UART_backend_t g_fake_backend;
+// Characters the fake backend "receives"
+const char *g_fake_rx = "";
+// Polls of the receiver that find it empty before the next character arrives
+uint32_t g_fake_rx_polls = 0;
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+//=============================================================================
+// Fake receiver, every poll takes 100 cycles and every read 25 cycles.
+static uint32_t fake_rxReady()
+{
+    UART_trace_simAdvance(100);
+    if(g_fake_rx_polls > 0)
+    {
+        g_fake_rx_polls--;
+        return 0;
+    }
+    return 1;
+}
+static char fake_read()
+{
+    UART_trace_simAdvance(25);
+    return *g_fake_rx ? *g_fake_rx++ : '\r';
+}
+//=============================================================================
+// Records one sample of the given length on a channel, through the simulated clock.
+static void consume_after(uint32_t channel, uint32_t cycles)
+{
+    //-----------------------------------------------------------------------------
+    uint32_t stamp = UART_trace_now();
+    //-----------------------------------------------------------------------------
+
+    UART_trace_simAdvance(cycles);
+    UART_trace_consumed(channel, stamp);
+}
+//=============================================================================
+// Main Function
+int main(void)
+{
+    //-----------------------------------------------------------------------------
+    UART_latency_t stats;
+    uint32_t stamp = 0;
+    uint32_t i = 0;
+    char buffer[BUFF_LEN];
+    //-----------------------------------------------------------------------------
+
+    //-----------------------------------------------------------------------------
+    /* Stamped receive without tracing or an initialized driver records nothing */
+    // Frame queued before tracing is enabled, must not be timed when it is sent later
+    UART_txQueue("x", 1, UART_PRIO_BULK);
+    UART_getCharStamped(&stamp);
+    UART_getStringStamped(buffer, &stamp);
+    UART_trace_init();
+    UART_getCharStamped(&stamp);
+    UART_getStringStamped(buffer, &stamp);
+    UART_trace_getStats(UART_TRACE_RX_DRIVER, &stats);
+    CHECK(stats.count == 0);
+    UART_trace_getStats(UART_TRACE_LINE_ASSEMBLY, &stats);
+    CHECK(stats.count == 0);
+
+    //-----------------------------------------------------------------------------
+    /* 1..1000 cycles, p99 is clamped to the largest sample */
+    for(i = 1; i <= 1000; i++)
+    {
+        consume_after(UART_TRACE_RX_APP, i);
+    }
+    UART_trace_getStats(UART_TRACE_RX_APP, &stats);
+    CHECK(stats.count == 1000);
+    CHECK(stats.min == 1);
+    CHECK(stats.avg == 500);
+    CHECK(stats.p99 == 1000);
+    CHECK(stats.max == 1000);
+
+    //-----------------------------------------------------------------------------
+    /* 99 samples of 10 and one outlier, p99 is the upper bound of the bucket holding 10 (10-11) */
+    for(i = 0; i < 99; i++)
+    {
+        consume_after(UART_TRACE_LINE_APP, 10);
+    }
+    consume_after(UART_TRACE_LINE_APP, 5000);
+    UART_trace_getStats(UART_TRACE_LINE_APP, &stats);
+    CHECK(stats.count == 100);
+    CHECK(stats.min == 10);
+    CHECK(stats.avg == 59);
+    CHECK(stats.p99 == 11);
+    CHECK(stats.max == 5000);
+
+    //-----------------------------------------------------------------------------
+    /* Values below 4 have exact buckets, the largest values land in the last bucket */
+    UART_trace_resetStats(UART_TRACE_LINE_APP);
+    for(i = 0; i < 3; i++)
+    {
+        UART_trace_record(UART_TRACE_LINE_APP, 3);
+    }
+    UART_trace_getStats(UART_TRACE_LINE_APP, &stats);
+    CHECK((stats.min == 3) && (stats.avg == 3) && (stats.p99 == 3) && (stats.max == 3));
+    UART_trace_record(UART_TRACE_TX_BULK, 0xFFFFFFF0);
+    UART_trace_getStats(UART_TRACE_TX_BULK, &stats);
+    CHECK((stats.min == 0xFFFFFFF0) && (stats.avg == 0xFFFFFFF0) && (stats.p99 == 0xFFFFFFF0) && (stats.max == 0xFFFFFFF0));
+
+    //-----------------------------------------------------------------------------
+    /* Empty and unknown channels read as all zero */
+    UART_trace_getStats(UART_TRACE_TX_HIGH, &stats);
+    CHECK((stats.count == 0) && (stats.min == 0) && (stats.avg == 0) && (stats.p99 == 0) && (stats.max == 0));
+    UART_trace_getStats(UART_TRACE_CHANNELS, &stats);
+    CHECK(stats.count == 0);
+
+    //-----------------------------------------------------------------------------
+    /* Stamped receive path on the fake backend */
+    g_fake_backend = test_backend_noop();
+    g_fake_backend.rxReady = fake_rxReady;
+    g_fake_backend.read = fake_read;
+    UART_setBackend(&g_fake_backend);
+    UART_init(UART_base_0);
+    UART_trace_init();
+
+    // Only the frame queued after tracing was enabled is timed
+    UART_trace_simAdvance(10);
+    UART_txFlush();
+    UART_txQueue("y", 1, UART_PRIO_BULK);
+    UART_trace_simAdvance(50);
+    UART_txFlush();
+    UART_trace_getStats(UART_TRACE_TX_BULK, &stats);
+    CHECK((stats.count == 1) && (stats.max == 50));
+
+    // Driver time is the read (25 cycles), the character was already waiting
+    g_fake_rx = "a";
+    CHECK(UART_getCharStamped(&stamp) == 'a');
+    UART_trace_getStats(UART_TRACE_RX_DRIVER, &stats);
+    CHECK((stats.count == 1) && (stats.min == 25) && (stats.max == 25));
+    CHECK(UART_trace_rxWaiting() == 1);
+
+    // Line of 3 characters: 3 reads and 2 arrivals after the first character was ready
+    g_fake_rx = "ab\r";
+    UART_getStringStamped(buffer, &stamp);
+    CHECK((buffer[0] == 'a') && (buffer[1] == 'b') && (buffer[2] == '\0'));
+    UART_trace_getStats(UART_TRACE_LINE_ASSEMBLY, &stats);
+    CHECK((stats.count == 1) && (stats.min == 275) && (stats.max == 275));
+    CHECK(UART_trace_rxWaiting() == 4);
+
+    // Application consumes the line 1000 cycles later
+    UART_trace_simAdvance(1000);
+    UART_trace_consumed(UART_TRACE_LINE_APP, stamp);
+    UART_trace_getStats(UART_TRACE_LINE_APP, &stats);
+    CHECK((stats.count == 1) && (stats.max == 1000));
+
+    // Character arriving while the driver waits: not counted as waiting, driver time is still from seeing it
+    g_fake_rx = "b";
+    g_fake_rx_polls = 3;
+    CHECK(UART_getCharStamped(&stamp) == 'b');
+    UART_trace_getStats(UART_TRACE_RX_DRIVER, &stats);
+    CHECK((stats.count == 5) && (stats.max == 25));
+    CHECK(UART_trace_rxWaiting() == 4);
+    UART_trace_resetStats(UART_TRACE_RX_DRIVER);
+    CHECK(UART_trace_rxWaiting() == 0);
+
+    UART_reset();
+
+    if(g_failures != 0)
+    {
+        printf("test_trace: %d check(s) failed\n", g_failures);
+        return 1;
+    }
+    printf("test_trace: all checks passed\n");
+    return 0;
+}
+//=============================================================================
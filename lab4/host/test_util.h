@@ -0,0 +1,66 @@
+/**
+ * ----------------------------------------------------------------------------
+ * test_util.h
+ * Description: Helpers shared by the host tests and benchmarks: a check
+ * macro, a small deterministic pseudo random generator and a backend whose
+ * operations do nothing, tests copy it and replace the operations they need.
+ * Every test is a single c file, so the globals are defined here.
+ * ----------------------------------------------------------------------------
+ */
+
+#ifndef TEST_UTIL_H
+#define TEST_UTIL_H
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Includes
+#include <stdint.h>
+#include <stdio.h>
+
+#include "../inc/UART_backend.h"
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+// Counts a failed check and prints where it is
+#define CHECK(cond) do { if(!(cond)) { printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); g_failures++; } } while(0)
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Global variables
+int g_failures = 0;
+uint32_t g_test_random = 1;
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+//=============================================================================
+// Small deterministic pseudo random generator, so runs can be repeated.
+static inline uint32_t test_random()
+{
+    g_test_random = (g_test_random * 1103515245) + 12345;
+    return g_test_random >> 8;
+}
+//=============================================================================
+// No-op backend operations, the receiver never has data and the transmitter is always ready.
+static inline void test_noop_init(uint32_t ui32Base) { (void) ui32Base; }
+static inline void test_noop_void() { }
+static inline uint32_t test_noop_false() { return 0; }
+static inline uint32_t test_noop_true() { return 1; }
+static inline char test_noop_read() { return 0; }
+static inline void test_noop_write(char c) { (void) c; }
+//=============================================================================
+// Returns a backend where every operation is a no-op.
+static inline UART_backend_t test_backend_noop()
+{
+    //-----------------------------------------------------------------------------
+    UART_backend_t backend;
+    //-----------------------------------------------------------------------------
+
+    backend.init = test_noop_init;
+    backend.reset = test_noop_void;
+    backend.rxReady = test_noop_false;
+    backend.read = test_noop_read;
+    backend.txReady = test_noop_true;
+    backend.write = test_noop_write;
+    backend.txDone = test_noop_true;
+    backend.clearErrors = test_noop_void;
+    return backend;
+}
+//=============================================================================
+
+#endif // TEST_UTIL_H
@@ -0,0 +1,308 @@
+/**
+ * ----------------------------------------------------------------------------
+ * uart_loadgen.c
+ * Description: Load generator for the echo application (main.c) built with
+ * the pseudo-terminal backend. Sends numbered lines at a configurable rate
+ * with a limited number in flight, matches the echoed lines and reports
+ * round-trip latency (min/avg/p50/p99/max) and throughput.
+ * ----------------------------------------------------------------------------
+ */
+
+#define _DEFAULT_SOURCE
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Includes
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../inc/UART_driver.h"
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+// Line length (excluding the terminator) the echo application can take
+#define LINE_MAX_LEN (BUFF_LEN - 2)
+// Shortest line, "L" + 6 digit sequence number + " "
+#define LINE_MIN_LEN 8
+// Give up when nothing has been echoed for this long
+#define IDLE_TIMEOUT_NS 2000000000LL
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Global variables
+// Send time of every line, 0 once its echo has been seen
+int64_t *g_sent_ns;
+// Round-trip time of every echoed line
+int64_t *g_rtt_ns;
+uint32_t g_echoed = 0;
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+//=============================================================================
+// Returns the monotonic clock in nanoseconds.
+static int64_t now_ns()
+{
+    //-----------------------------------------------------------------------------
+    struct timespec ts;
+    //-----------------------------------------------------------------------------
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((int64_t) ts.tv_sec * 1000000000LL) + ts.tv_nsec;
+}
+//=============================================================================
+// Sorting order for the round-trip times.
+static int compare_ns(const void *a, const void *b)
+{
+    //-----------------------------------------------------------------------------
+    int64_t x = *(const int64_t*) a;
+    int64_t y = *(const int64_t*) b;
+    //-----------------------------------------------------------------------------
+
+    return (x > y) - (x < y);
+}
+//=============================================================================
+// Writes all of a buffer to a non-blocking descriptor.
+static void write_all(int fd, const char *buffer, size_t length)
+{
+    //-----------------------------------------------------------------------------
+    ssize_t written;
+    struct pollfd pfd;
+    //-----------------------------------------------------------------------------
+
+    while(length > 0)
+    {
+        written = write(fd, buffer, length);
+        if(written > 0)
+        {
+            buffer += written;
+            length -= written;
+        }
+        else if((written < 0) && (errno != EAGAIN) && (errno != EINTR))
+        {
+            perror("write");
+            exit(EXIT_FAILURE);
+        }
+        else
+        {
+            pfd.fd = fd;
+            pfd.events = POLLOUT;
+            poll(&pfd, 1, 10);
+        }
+    }
+}
+//=============================================================================
+// Checks one received line, records the round-trip time if it is one of ours.
+static void handle_line(const char *line, uint32_t length, uint32_t size, uint32_t count, int64_t now)
+{
+    //-----------------------------------------------------------------------------
+    uint32_t seq = 0;
+    uint32_t i = 0;
+    //-----------------------------------------------------------------------------
+
+    // Prompts ("Input: ", "Echo: ") and empty lines are skipped
+    if((length != size) || (line[0] != 'L'))
+    {
+        return;
+    }
+    for(i = 1; i < 7; i++)
+    {
+        if((line[i] < '0') || (line[i] > '9'))
+        {
+            return;
+        }
+        seq = (seq * 10) + (line[i] - '0');
+    }
+
+    if((seq < count) && (g_sent_ns[seq] != 0))
+    {
+        g_rtt_ns[g_echoed++] = now - g_sent_ns[seq];
+        g_sent_ns[seq] = 0;
+    }
+}
+//=============================================================================
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "usage: %s [-p path] [-n count] [-r rate] [-s size] [-w window] [-k]\n"
+            "  -p path    PTY slave of the echo application (default $UART_PTY_LINK)\n"
+            "  -n count   lines to send (default 1000)\n"
+            "  -r rate    lines per second, 0 sends as fast as the window allows (default 0)\n"
+            "  -s size    line length in characters, %d-%d (default 32)\n"
+            "  -w window  lines in flight at most (default 1)\n"
+            "  -k         keep the application running, do not send \"end\" afterwards\n",
+            name, LINE_MIN_LEN, LINE_MAX_LEN);
+    exit(EXIT_FAILURE);
+}
+//=============================================================================
+// Main Function
+int main(int argc, char **argv)
+{
+    //-----------------------------------------------------------------------------
+    const char *path = getenv("UART_PTY_LINK");
+    uint32_t count = 1000;
+    uint32_t rate = 0;
+    uint32_t size = 32;
+    uint32_t window = 1;
+    int keep = 0;
+    int opt;
+
+    int fd;
+    struct termios tio;
+    struct pollfd pfd;
+    char line[BUFF_LEN + 1];
+    uint32_t line_len = 0;
+    char rx[4096];
+    ssize_t received;
+    ssize_t i;
+    char message[BUFF_LEN];
+
+    uint32_t sent = 0;
+    int64_t start;
+    int64_t now;
+    int64_t next_send;
+    int64_t last_progress;
+    int64_t end;
+    int timeout_ms;
+    double elapsed_s;
+    double sum_us = 0;
+    //-----------------------------------------------------------------------------
+
+    while((opt = getopt(argc, argv, "p:n:r:s:w:k")) != -1)
+    {
+        switch(opt)
+        {
+            case 'p' : path = optarg; break;
+            case 'n' : count = strtoul(optarg, NULL, 0); break;
+            case 'r' : rate = strtoul(optarg, NULL, 0); break;
+            case 's' : size = strtoul(optarg, NULL, 0); break;
+            case 'w' : window = strtoul(optarg, NULL, 0); break;
+            case 'k' : keep = 1; break;
+            default : usage(argv[0]);
+        }
+    }
+    if((path == NULL) || (count == 0) || (count > 1000000) || (size < LINE_MIN_LEN) || (size > LINE_MAX_LEN) || (window == 0))
+    {
+        usage(argv[0]);
+    }
+
+    //-----------------------------------------------------------------------------
+    /* Open the application's pseudo-terminal */
+    fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if(fd < 0)
+    {
+        perror(path);
+        return EXIT_FAILURE;
+    }
+    tcgetattr(fd, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(fd, TCSANOW, &tio);
+
+    g_sent_ns = calloc(count, sizeof(int64_t));
+    g_rtt_ns = calloc(count, sizeof(int64_t));
+    if((g_sent_ns == NULL) || (g_rtt_ns == NULL))
+    {
+        perror("calloc");
+        return EXIT_FAILURE;
+    }
+
+    //-----------------------------------------------------------------------------
+    /* Send and match echoes */
+    start = now_ns();
+    next_send = start;
+    last_progress = start;
+    end = start;
+    while(g_echoed < count)
+    {
+        now = now_ns();
+
+        // Send every line that is due, as long as the window has room
+        while((sent < count) && ((sent - g_echoed) < window) && (now >= next_send))
+        {
+            snprintf(message, sizeof(message), "L%06u ", sent);
+            memset(&message[LINE_MIN_LEN], 'x', size - LINE_MIN_LEN);
+            message[size] = '\r';
+            g_sent_ns[sent] = now_ns();
+            write_all(fd, message, size + 1);
+            sent++;
+            if(rate != 0)
+            {
+                next_send += 1000000000LL / rate;
+            }
+        }
+
+        // Wait for echoes, but not past the next scheduled send
+        timeout_ms = 100;
+        if((rate != 0) && (sent < count) && ((sent - g_echoed) < window))
+        {
+            timeout_ms = (next_send > now) ? (int) ((next_send - now) / 1000000) : 0;
+        }
+        pfd.fd = fd;
+        pfd.events = POLLIN;
+        poll(&pfd, 1, timeout_ms);
+
+        received = read(fd, rx, sizeof(rx));
+        now = now_ns();
+        for(i = 0; i < received; i++)
+        {
+            if((rx[i] == '\n') || (rx[i] == '\r'))
+            {
+                handle_line(line, line_len, size, count, now);
+                line_len = 0;
+            }
+            else if(line_len < BUFF_LEN)
+            {
+                line[line_len++] = rx[i];
+            }
+        }
+        if(received > 0)
+        {
+            last_progress = now;
+            end = now;
+        }
+
+        if((now - last_progress) > IDLE_TIMEOUT_NS)
+        {
+            fprintf(stderr, "no echo for %lld ms, giving up\n", IDLE_TIMEOUT_NS / 1000000);
+            break;
+        }
+    }
+
+    if(!keep)
+    {
+        write_all(fd, "end\r", 4);
+    }
+    close(fd);
+
+    //-----------------------------------------------------------------------------
+    /* Report */
+    elapsed_s = (double) (end - start) / 1e9;
+    printf("sent %u, echoed %u, lost %u, size %u, window %u\n", sent, g_echoed, sent - g_echoed, size, window);
+    if(rate != 0)
+    {
+        printf("target rate %u lines/s\n", rate);
+    }
+    if(g_echoed == 0)
+    {
+        return EXIT_FAILURE;
+    }
+
+    qsort(g_rtt_ns, g_echoed, sizeof(int64_t), compare_ns);
+    for(i = 0; i < (ssize_t) g_echoed; i++)
+    {
+        sum_us += (double) g_rtt_ns[i] / 1e3;
+    }
+    printf("rtt us: min %.1f avg %.1f p50 %.1f p99 %.1f max %.1f\n",
+           (double) g_rtt_ns[0] / 1e3,
+           sum_us / g_echoed,
+           (double) g_rtt_ns[g_echoed / 2] / 1e3,
+           (double) g_rtt_ns[g_echoed - 1 - (g_echoed / 100)] / 1e3,
+           (double) g_rtt_ns[g_echoed - 1] / 1e3);
+    printf("throughput: %.1f lines/s, %.1f bytes/s each way\n", g_echoed / elapsed_s, (g_echoed * (double) (size + 1)) / elapsed_s);
+
+    return (g_echoed == count) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+//=============================================================================
@@ -0,0 +1,40 @@
+/**
+ * ----------------------------------------------------------------------------
+ * UART_autobaud.h
+ * Description: UART auto-baud detection h file
+ * ----------------------------------------------------------------------------
+ */
+
+#ifndef UART_AUTOBAUD_H
+#define UART_AUTOBAUD_H
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Includes
+#include <stdint.h>
+
+#include "register_defines.h"
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+// Sync character sent by the peer, 0x55 gives an edge at every bit boundary (start bit 0, bits 1010101 0, stop bit 1)
+#define UART_AUTOBAUD_SYNC 0x55
+// Sent back once the divisors have been programmed, the peer stops sending sync characters and answers with UART_AUTOBAUD_CONFIRM
+#define UART_AUTOBAUD_ACK 0x06
+// Confirmation from the peer. Differs from the sync character, which a stream of sync characters (a square wave) can not produce however it is framed
+#define UART_AUTOBAUD_CONFIRM 0xC3
+// Edges in one sync character, from the falling edge of the start bit to the rising edge of the stop bit (9 bit times)
+#define UART_AUTOBAUD_EDGES 10
+
+//=============================================================================
+#ifndef UART_HOST
+// Only available with the TM4C129 register backend, since the Rx pin itself is sampled.
+// This function initializes the UART and sets the baud rate from a sync character sent by the peer, confirmed with a test exchange.
+// Returns the baud rate in use, or 0 (driver left at 9600 baud) if no sync character was seen within timeout_ms or the exchange failed.
+extern uint32_t UART_autoBaud(uint32_t ui32Base, uint32_t timeout_ms);
+// This function programs new baud rate divisors into the UART in use.
+extern void UART_setDivisors(uint32_t ibrd, uint32_t fbrd);
+#endif
+// This function computes the divisors from the edge timestamps (in cycles) of one sync character. Returns the baud rate, or 0 if the edges do not look like a sync character.
+extern uint32_t UART_autoBaudCompute(const uint32_t *edges, uint32_t *ibrd, uint32_t *fbrd);
+//=============================================================================
+
+#endif // UART_AUTOBAUD_H
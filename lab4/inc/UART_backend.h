@@ -0,0 +1,51 @@
+/**
+ * ----------------------------------------------------------------------------
+ * UART_backend.h
+ * Description: UART transport backend h file. The public UART driver API
+ * is implemented on top of one of these backends.
+ * ----------------------------------------------------------------------------
+ */
+
+#ifndef UART_BACKEND_H
+#define UART_BACKEND_H
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Includes
+#include <stdint.h>
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+// Operations a transport has to provide. None of them may block, except init and reset.
+// rxReady may idle briefly (host backends, to save CPU), but only while UART_txPending() returns 0.
+typedef struct
+{
+    // Sets up the transport, ui32Base selects the UART (backends without several UARTs may ignore it)
+    void (*init)(uint32_t ui32Base);
+    // Returns the transport to a safe state, must be harmless when init hasn't been called
+    void (*reset)();
+    // Returns 1 if a received character is waiting, 0 otherwise
+    uint32_t (*rxReady)();
+    // Reads the waiting character, or an error code (129-132) if there was an error with the data received
+    char (*read)();
+    // Returns 1 if the transmitter can take another character, 0 otherwise
+    uint32_t (*txReady)();
+    // Writes one character, only called when txReady returned 1
+    void (*write)(char c);
+    // Returns 1 once every written character has been sent, 0 otherwise
+    uint32_t (*txDone)();
+    // Clears latched receive errors, so they are not reported for the next character read
+    void (*clearErrors)();
+} UART_backend_t;
+
+//=============================================================================
+#ifndef UART_HOST
+// TM4C129 memory-mapped register backend (default on target)
+extern const UART_backend_t g_UART_backend_tm4c;
+#else
+// Linux pseudo-terminal backend (default on the host)
+extern const UART_backend_t g_UART_backend_pty;
+#endif
+// This function selects the backend used by the driver, must be called before UART_init.
+extern void UART_setBackend(const UART_backend_t *backend);
+//=============================================================================
+
+#endif // UART_BACKEND_H
@@ -0,0 +1,76 @@
+/**
+ * ----------------------------------------------------------------------------
+ * UART_trace.h
+ * Description: UART receive latency tracing h file
+ * ----------------------------------------------------------------------------
+ */
+
+#ifndef UART_TRACE_H
+#define UART_TRACE_H
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Includes
+#include <stdint.h>
+
+#include "register_defines.h"
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+// System clock the cycle counts are measured in (default 16Mhz, page 1966)
+#define UART_TRACE_CLOCK_HZ 16000000
+
+// Latency channels, every channel has its own histogram
+// Driver saw the byte in the receiver -> driver returned it
+// (a byte already waiting when UART_getChar was called is counted by UART_trace_rxWaiting instead of timed)
+#define UART_TRACE_RX_DRIVER 0
+// Driver returned the byte -> application consumed it
+#define UART_TRACE_RX_APP 1
+// Driver saw the first byte of a line -> line terminator was read
+#define UART_TRACE_LINE_ASSEMBLY 2
+// Line terminator was read -> application consumed the line
+#define UART_TRACE_LINE_APP 3
+// High priority frame queued -> first byte written to the transmitter
+#define UART_TRACE_TX_HIGH 4
+// Bulk frame queued -> first byte written to the transmitter
+#define UART_TRACE_TX_BULK 5
+// Number of channels
+#define UART_TRACE_CHANNELS 6
+
+// Latency statistics for one channel, all values in system clock cycles
+typedef struct
+{
+    uint32_t count;
+    uint32_t min;
+    uint32_t avg;
+    // Upper bound of the histogram bucket holding the 99th percentile (at most 25% above the true value)
+    uint32_t p99;
+    uint32_t max;
+} UART_latency_t;
+
+//=============================================================================
+// This function enables the cycle counter and the timestamped receive path, all statistics are cleared.
+extern void UART_trace_init();
+// This function starts the cycle counter if it isn't running, the statistics are not touched.
+extern void UART_trace_startCounter();
+// This function returns the current cycle count.
+extern uint32_t UART_trace_now();
+// This function receives one character and stores the cycle count when it was read by the driver in rx_stamp.
+extern char UART_getCharStamped(uint32_t *rx_stamp);
+// This function receives a string and stores the cycle count when the line terminator was read by the driver in rx_stamp.
+extern void UART_getStringStamped(char *buffer, uint32_t *rx_stamp);
+// This function is called by the application when it consumes a byte or line, rx_stamp is the stamp from the receive function.
+extern void UART_trace_consumed(uint32_t channel, uint32_t rx_stamp);
+// This function returns how many traced bytes were already waiting in the receiver when UART_getChar was called.
+extern uint32_t UART_trace_rxWaiting();
+// This function records one latency sample (in cycles) into the histogram of a channel.
+extern void UART_trace_record(uint32_t channel, uint32_t cycles);
+// This function reads the latency statistics of a channel.
+extern void UART_trace_getStats(uint32_t channel, UART_latency_t *stats);
+// This function clears the statistics of a channel.
+extern void UART_trace_resetStats(uint32_t channel);
+#ifdef UART_HOST
+// This function advances the simulated cycle counter used instead of DWT on the host.
+extern void UART_trace_simAdvance(uint32_t cycles);
+#endif
+//=============================================================================
+
+#endif // UART_TRACE_H
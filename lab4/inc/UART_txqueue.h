@@ -0,0 +1,45 @@
+/**
+ * ----------------------------------------------------------------------------
+ * UART_txqueue.h
+ * Description: UART priority transmit queue h file
+ * ----------------------------------------------------------------------------
+ */
+
+#ifndef UART_TXQUEUE_H
+#define UART_TXQUEUE_H
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Includes
+#include <stdint.h>
+
+#include "register_defines.h"
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+// Priority classes, lower number is sent first
+#define UART_PRIO_HIGH 0
+#define UART_PRIO_BULK 1
+#define UART_PRIO_CLASSES 2
+
+// Largest frame in bytes. A frame is never split, so this bounds how long a high priority frame waits behind bulk data.
+#define UART_TX_FRAME_MAX 32
+// Number of frames that can be queued per priority class
+#define UART_TX_SLOTS 8
+
+//=============================================================================
+// This function queues one frame of length bytes in a priority class. Returns 1 if queued, 0 if the class is full or the frame too long.
+// May be called from an interrupt handler, but nothing is sent from there: queued frames only go out while the application is in
+// UART_getChar, UART_putChar, UART_putString, UART_txFlush or UART_txService, so the latency bound only holds while it calls one of them.
+extern uint32_t UART_txQueue(const char *frame, uint32_t length, uint32_t prio);
+// This function writes the next queued byte if the transmitter has room, it never blocks. Must not be called from an interrupt handler.
+extern void UART_txService();
+// This function services the queue until every queued frame has been written.
+extern void UART_txFlush();
+// This function returns 1 if there are frames left to send, 0 otherwise.
+extern uint32_t UART_txPending();
+// This function drops every queued frame.
+extern void UART_txReset();
+// This function splits a string into frames and queues them in a priority class, waiting for room when the class is full.
+extern void UART_putStringPrio(char *string, uint32_t prio);
+//=============================================================================
+
+#endif // UART_TXQUEUE_H
@@ -28,6 +28,12 @@
 #define RCGCDMA  0x400FE60C
 // DMA Configuration
 #define DMACFG 0x400FF004
+// Debug Exception and Monitor Control (TRCENA is bit 24)
+#define DEMCR 0xE000EDFC
+// Data Watchpoint and Trace Control (CYCCNTENA is bit 0)
+#define DWT_CTRL 0xE0001000
+// Data Watchpoint and Trace Cycle Count
+#define DWT_CYCCNT 0xE0001004
 //-----------------------------------------------------------------------------
 // Base
 //-----------------------------------------------------------------------------
@@ -83,6 +89,10 @@
 //-----------------------------------------------------------------------------
 // Offsets
 //-----------------------------------------------------------------------------
+// GPIO Data (address bits 9:2 mask which pins are read/written)
+#define GPIODATA 0x000
+// GPIO Direction
+#define GPIODIR 0x400
 // GPIO Alternate Function Select
 #define GPIOAFSEL 0x420
 // GPIO 2-mA Drive Select
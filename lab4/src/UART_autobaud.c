@@ -0,0 +1,328 @@
+/**
+ * ----------------------------------------------------------------------------
+ * UART_autobaud.c
+ * Description: UART auto-baud detection c file. The Rx pin is temporarily
+ * switched to a GPIO input and the edges of a sync character (0x55) are
+ * timestamped with the DWT cycle counter. The bit time gives the baud rate
+ * divisors, which are snapped to a standard rate when within 3%. The edges
+ * are polled, so the detection is reliable up to about 115200 baud at the
+ * default 16Mhz system clock.
+ * ----------------------------------------------------------------------------
+ */
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Includes
+#include "../inc/UART_autobaud.h"
+#include "../inc/UART_driver.h"
+#include "../inc/UART_trace.h"
+#include "../inc/register_defines.h"
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+// Shortest accepted bit time (250000 baud), the polling loop can not resolve edges much closer than this
+#define AUTOBAUD_MIN_BIT_CYCLES (UART_TRACE_CLOCK_HZ / 250000)
+// Longest accepted bit time (300 baud, with some margin for polling jitter)
+#define AUTOBAUD_MAX_BIT_CYCLES (UART_TRACE_CLOCK_HZ / 290)
+// Edges are seen up to a few passes of the polling loop late, this is allowed on top of the 25% per bit tolerance
+#define AUTOBAUD_JITTER_CYCLES 24
+// Number of standard baud rates
+#define AUTOBAUD_STANDARD_RATES 9
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Global variables
+#ifndef UART_HOST
+extern uint32_t g_UART_base_used;
+extern uint32_t g_UART_port_base_used;
+extern uint32_t g_UART_rx_pin;
+#endif
+
+// Rates the measurement is snapped to when close enough
+const uint32_t g_autobaud_standard_rates[AUTOBAUD_STANDARD_RATES] = {1200, 2400, 4800, 9600, 19200, 38400, 57600, 115200, 230400};
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+//=============================================================================
+// The measurement and the register access only exist on target, the host can only use UART_autoBaudCompute
+#ifndef UART_HOST
+//=============================================================================
+// Waits until the (masked) Rx pin reads level, returns the cycle count of the edge in edge_stamp. Returns 0 on timeout, 1 otherwise.
+static uint32_t autobaud_wait_level(volatile uint32_t *GPIODATA_pointer, uint32_t level, uint32_t timeout_cycles, uint32_t *edge_stamp)
+{
+    //-----------------------------------------------------------------------------
+    uint32_t start = UART_trace_now();
+    uint32_t now = start;
+    //-----------------------------------------------------------------------------
+
+    while(((*GPIODATA_pointer) != 0) != level)
+    {
+        now = UART_trace_now();
+        if((now - start) > timeout_cycles)
+        {
+            return 0;
+        }
+    }
+
+    // Stamp right after the level change is seen
+    *edge_stamp = UART_trace_now();
+    return 1;
+}
+//=============================================================================
+// Waits for one received character for at most timeout_cycles. Returns the UARTDR value (errors in bits 11:8), or 0xFFFFFFFF on timeout.
+static uint32_t autobaud_receive(uint32_t timeout_cycles)
+{
+    //-----------------------------------------------------------------------------
+    volatile uint32_t *UARTDR_pointer = (volatile uint32_t*) (g_UART_base_used + UARTDR);
+    volatile uint32_t *UARTFR_pointer = (volatile uint32_t*) (g_UART_base_used + UARTFR);
+
+    uint32_t start = UART_trace_now();
+    //-----------------------------------------------------------------------------
+
+    // This bit (4) is cleared when the receiver isn't empty
+    while((*UARTFR_pointer) & (1 << 4))
+    {
+        if((UART_trace_now() - start) > timeout_cycles)
+        {
+            return 0xFFFFFFFF;
+        }
+    }
+
+    return *UARTDR_pointer;
+}
+//=============================================================================
+// This function initializes the UART and sets the baud rate from a sync character sent by the peer, confirmed with a test exchange.
+// The peer keeps sending UART_AUTOBAUD_SYNC until it receives UART_AUTOBAUD_ACK, and then answers with UART_AUTOBAUD_CONFIRM.
+// Returns the baud rate in use, or 0 (driver left at 9600 baud) if no sync character was seen within timeout_ms or the exchange failed.
+uint32_t UART_autoBaud(uint32_t ui32Base, uint32_t timeout_ms)
+{
+    //-----------------------------------------------------------------------------
+    volatile uint32_t *UARTDR_pointer;
+    volatile uint32_t *UARTFR_pointer;
+    volatile uint32_t *UARTRSR_ECR_pointer;
+    volatile uint32_t *GPIODATA_pointer;
+    volatile uint32_t *GPIOAFSEL_pointer;
+    volatile uint32_t *GPIODIR_pointer;
+
+    uint32_t edges[UART_AUTOBAUD_EDGES];
+    uint32_t timeout_cycles = 0;
+    uint32_t start = 0;
+    uint32_t level = 0;
+    uint32_t baud = 0;
+    uint32_t ibrd = 0;
+    uint32_t fbrd = 0;
+    uint32_t received = 0;
+    uint32_t elapsed = 0;
+    uint32_t i = 0;
+    uint32_t ok = 0;
+    //-----------------------------------------------------------------------------
+
+    // Set up the UART module and pins as usual (9600 baud), this also stores which port and Rx pin are used
+    UART_init(ui32Base);
+    UART_trace_startCounter();
+
+    UARTDR_pointer = (volatile uint32_t*) (g_UART_base_used + UARTDR);
+    UARTFR_pointer = (volatile uint32_t*) (g_UART_base_used + UARTFR);
+    UARTRSR_ECR_pointer = (volatile uint32_t*) (g_UART_base_used + UARTRSR_ECR);
+    // Address bits 9:2 of GPIODATA mask the pins, so this only reads the Rx pin
+    GPIODATA_pointer = (volatile uint32_t*) (g_UART_port_base_used + GPIODATA + (g_UART_rx_pin << 2));
+    GPIOAFSEL_pointer = (volatile uint32_t*) (g_UART_port_base_used + GPIOAFSEL);
+    GPIODIR_pointer = (volatile uint32_t*) (g_UART_port_base_used + GPIODIR);
+
+    // Limit the timeout so it fits in the 32 bit cycle counter
+    if(timeout_ms > 200000)
+    {
+        timeout_ms = 200000;
+    }
+    timeout_cycles = timeout_ms * (UART_TRACE_CLOCK_HZ / 1000);
+
+    //-----------------------------------------------------------------------------
+    /* Measure the sync character */
+    // Hand the Rx pin over from the UART to GPIO, as an input
+    *GPIODIR_pointer &= ~g_UART_rx_pin;
+    *GPIOAFSEL_pointer &= ~g_UART_rx_pin;
+
+    // The elapsed time is read once before every wait and checked before the remaining time is computed, so it can never wrap
+    start = UART_trace_now();
+    while((baud == 0) && ((elapsed = (UART_trace_now() - start)) < timeout_cycles))
+    {
+        // The line must be idle (high) before a start bit can be recognized
+        if(!autobaud_wait_level(GPIODATA_pointer, 1, timeout_cycles - elapsed, &edges[0]))
+        {
+            break;
+        }
+        // Falling edge of the start bit
+        elapsed = UART_trace_now() - start;
+        if((elapsed >= timeout_cycles) || !autobaud_wait_level(GPIODATA_pointer, 0, timeout_cycles - elapsed, &edges[0]))
+        {
+            break;
+        }
+
+        // Every following bit of 0x55 toggles the line, up to the rising edge of the stop bit
+        level = 0;
+        ok = 1;
+        for(i = 1; i < UART_AUTOBAUD_EDGES; i++)
+        {
+            level ^= 1;
+            if(!autobaud_wait_level(GPIODATA_pointer, level, 2 * AUTOBAUD_MAX_BIT_CYCLES, &edges[i]))
+            {
+                ok = 0;
+                break;
+            }
+        }
+
+        // Anything that is not a sync character is skipped and the next one is awaited
+        if(ok)
+        {
+            baud = UART_autoBaudCompute(edges, &ibrd, &fbrd);
+        }
+    }
+
+    // Hand the Rx pin back to the UART
+    *GPIOAFSEL_pointer |= g_UART_rx_pin;
+
+    if(baud == 0)
+    {
+        return 0;
+    }
+
+    //-----------------------------------------------------------------------------
+    /* Program and confirm */
+    UART_setDivisors(ibrd, fbrd);
+
+    // Let the stop bit pass, then drop anything the UART picked up while switching and clear the errors it caused
+    start = UART_trace_now();
+    while((UART_trace_now() - start) < (2 * ((edges[UART_AUTOBAUD_EDGES - 1] - edges[0]) / 9)))
+    {
+        ;
+    }
+    while(!((*UARTFR_pointer) & (1 << 4)))
+    {
+        received = *UARTDR_pointer;
+    }
+    *UARTRSR_ECR_pointer = 0x00000000;
+
+    // Tell the peer we are ready, it stops sending sync characters and answers with the confirmation at the new rate
+    // The peer only sends the confirmation once it has decoded the ACK, so receiving it proves both directions work
+    UART_putChar(UART_AUTOBAUD_ACK);
+    start = UART_trace_now();
+    while((elapsed = (UART_trace_now() - start)) < timeout_cycles)
+    {
+        received = autobaud_receive(timeout_cycles - elapsed);
+
+        // Confirmation without receive errors (bits 11:8), the link works
+        if((received != 0xFFFFFFFF) && !(received & 0xF00) && ((received & 0xFF) == UART_AUTOBAUD_CONFIRM))
+        {
+            return baud;
+        }
+
+        // Sync characters still in flight may be read whole or, when picked up mid-character, with errors, skip them
+        if((received != 0xFFFFFFFF) && (((received & 0xFF) == UART_AUTOBAUD_SYNC) || (received & 0xF00)))
+        {
+            *UARTRSR_ECR_pointer = 0x00000000;
+            continue;
+        }
+
+        // Timeout or any other character
+        break;
+    }
+
+    // Not confirmed, go back to the default rate
+    *UARTRSR_ECR_pointer = 0x00000000;
+    UART_setDivisors(104, 11);
+    return 0;
+}
+#endif // UART_HOST
+//=============================================================================
+// This function computes the divisors from the edge timestamps (in cycles) of one sync character. Returns the baud rate, or 0 if the edges do not look like a sync character.
+// BRD = clock / (16 * baud) = bit_cycles / 16, and UARTFBRD = integer(fraction * 64 + 0.5), so BRD * 64 = bit_cycles * 4 is computed rounded and split up.
+uint32_t UART_autoBaudCompute(const uint32_t *edges, uint32_t *ibrd, uint32_t *fbrd)
+{
+    //-----------------------------------------------------------------------------
+    uint32_t span = edges[UART_AUTOBAUD_EDGES - 1] - edges[0];
+    uint32_t bit_cycles = span / 9;
+    uint32_t interval = 0;
+    uint32_t measured = 0;
+    uint32_t baud = 0;
+    uint32_t divisor = 0;
+    uint32_t i = 0;
+    //-----------------------------------------------------------------------------
+
+    if((bit_cycles < AUTOBAUD_MIN_BIT_CYCLES) || (bit_cycles > AUTOBAUD_MAX_BIT_CYCLES))
+    {
+        return 0;
+    }
+
+    // Every bit must be within 25% (plus the polling jitter) of the average, otherwise this was not 0x55 (or a glitch)
+    for(i = 1; i < UART_AUTOBAUD_EDGES; i++)
+    {
+        interval = edges[i] - edges[i - 1];
+        if(((interval + AUTOBAUD_JITTER_CYCLES) * 4 < bit_cycles * 3) || (interval * 4 > (bit_cycles * 5) + (AUTOBAUD_JITTER_CYCLES * 4)))
+        {
+            return 0;
+        }
+    }
+
+    // Measured rate, rounded
+    measured = ((UART_TRACE_CLOCK_HZ * 9) + (span / 2)) / span;
+
+    // Snap to a standard rate within 3%, this removes the polling error
+    for(i = 0; i < AUTOBAUD_STANDARD_RATES; i++)
+    {
+        if(((measured > g_autobaud_standard_rates[i]) ? (measured - g_autobaud_standard_rates[i]) : (g_autobaud_standard_rates[i] - measured)) * 100 <= g_autobaud_standard_rates[i] * 3)
+        {
+            baud = g_autobaud_standard_rates[i];
+            break;
+        }
+    }
+
+    if(baud != 0)
+    {
+        divisor = ((UART_TRACE_CLOCK_HZ * 4) + (baud / 2)) / baud;
+    }
+    else
+    {
+        // Non-standard rate, use the measurement directly
+        baud = measured;
+        divisor = ((span * 4) + 4) / 9;
+    }
+
+    *ibrd = divisor / 64;
+    *fbrd = divisor % 64;
+
+    // The integer divisor must be at least 1 and fit in 16 bits
+    if((*ibrd == 0) || (*ibrd > 0xFFFF))
+    {
+        return 0;
+    }
+
+    return baud;
+}
+//=============================================================================
+#ifndef UART_HOST
+// This function programs new baud rate divisors into the UART in use.
+void UART_setDivisors(uint32_t ibrd, uint32_t fbrd)
+{
+    //-----------------------------------------------------------------------------
+    volatile uint32_t *UARTCTL_pointer = (volatile uint32_t*) (g_UART_base_used + UARTCTL);
+    volatile uint32_t *UARTIBRD_pointer = (volatile uint32_t*) (g_UART_base_used + UARTIBRD);
+    volatile uint32_t *UARTFBRD_pointer = (volatile uint32_t*) (g_UART_base_used + UARTFBRD);
+    volatile uint32_t *UARTLCRH_pointer = (volatile uint32_t*) (g_UART_base_used + UARTLCRH);
+    volatile uint32_t *UARTFR_pointer = (volatile uint32_t*) (g_UART_base_used + UARTFR);
+    //-----------------------------------------------------------------------------
+
+    // Wait while the UART is busy, so the character being sent isn't cut off
+    while ((*UARTFR_pointer) & (1 << 3))
+    {
+        ;
+    }
+
+    // Clear UARTEN bit (bit 0). Disabling UART for configuration
+    *UARTCTL_pointer &= ~(1 << 0);
+
+    *UARTIBRD_pointer = ibrd;
+    *UARTFBRD_pointer = fbrd & 0x3F;
+    // A write to UARTLCRH is necessary for the baud rate changes to take effect
+    *UARTLCRH_pointer = *UARTLCRH_pointer;
+
+    // Enable UARTEN bit (bit 0).
+    *UARTCTL_pointer |= (1 << 0);
+}
+#endif // UART_HOST
+//=============================================================================
@@ -0,0 +1,198 @@
+/**
+ * ----------------------------------------------------------------------------
+ * UART_pty.c
+ * Description: Linux pseudo-terminal (PTY) backend for the UART driver,
+ * only built on the host (UART_HOST). The driver owns the master side, the
+ * peer (e.g. host/uart_loadgen or a terminal program) opens the slave side,
+ * whose path is printed on stderr and, if the environment variable
+ * UART_PTY_LINK is set, linked to from that path.
+ * ----------------------------------------------------------------------------
+ */
+
+#ifdef UART_HOST
+
+#define _XOPEN_SOURCE 600
+#define _DEFAULT_SOURCE
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Includes
+#include "../inc/UART_backend.h"
+#include "../inc/UART_txqueue.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+// How long rxReady may sleep waiting for input when nothing is queued for transmission, keeps an idle driver from spinning a whole core
+#define PTY_RX_POLL_MS 1
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Global variables
+int g_pty_master = -1;
+// The slave side is kept open so reads on the master do not fail while no peer is connected
+int g_pty_slave = -1;
+// Character read ahead by rxReady
+int g_pty_rx_waiting = 0;
+char g_pty_rx_char;
+// Link created from UART_PTY_LINK, removed again by reset
+const char *g_pty_link = NULL;
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+//=============================================================================
+// Opens a new pseudo-terminal in raw mode (8 bits, no echo, no line editing).
+static void pty_init(uint32_t ui32Base)
+{
+    //-----------------------------------------------------------------------------
+    struct termios tio;
+    char *slave_name;
+    //-----------------------------------------------------------------------------
+
+    // There is only one PTY, the base is ignored
+    (void) ui32Base;
+
+    g_pty_master = posix_openpt(O_RDWR | O_NOCTTY);
+    if((g_pty_master < 0) || (grantpt(g_pty_master) != 0) || (unlockpt(g_pty_master) != 0) || ((slave_name = ptsname(g_pty_master)) == NULL))
+    {
+        perror("UART: could not create pseudo-terminal");
+        exit(EXIT_FAILURE);
+    }
+
+    g_pty_slave = open(slave_name, O_RDWR | O_NOCTTY);
+    if(g_pty_slave < 0)
+    {
+        perror("UART: could not open pseudo-terminal slave");
+        exit(EXIT_FAILURE);
+    }
+
+    // Raw mode on the line discipline, so characters pass through unchanged like on a real UART
+    tcgetattr(g_pty_slave, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(g_pty_slave, TCSANOW, &tio);
+
+    // Reads and writes on the master must never block, the driver polls instead
+    fcntl(g_pty_master, F_SETFL, fcntl(g_pty_master, F_GETFL) | O_NONBLOCK);
+
+    g_pty_link = getenv("UART_PTY_LINK");
+    if(g_pty_link != NULL)
+    {
+        unlink(g_pty_link);
+        if(symlink(slave_name, g_pty_link) != 0)
+        {
+            perror("UART: could not create UART_PTY_LINK");
+            g_pty_link = NULL;
+        }
+    }
+
+    fprintf(stderr, "UART: pseudo-terminal on %s\n", slave_name);
+    g_pty_rx_waiting = 0;
+}
+//=============================================================================
+// Closes the pseudo-terminal, harmless when it was never opened.
+static void pty_reset()
+{
+    if(g_pty_master >= 0)
+    {
+        close(g_pty_master);
+        g_pty_master = -1;
+    }
+    if(g_pty_slave >= 0)
+    {
+        close(g_pty_slave);
+        g_pty_slave = -1;
+    }
+    if(g_pty_link != NULL)
+    {
+        unlink(g_pty_link);
+        g_pty_link = NULL;
+    }
+    g_pty_rx_waiting = 0;
+}
+//=============================================================================
+// Returns 1 if a received character is waiting, 0 otherwise.
+// Sleeps at most PTY_RX_POLL_MS when nothing has arrived and the transmit queue is empty, queued frames are serviced between polls and must not be slowed down.
+static uint32_t pty_rxReady()
+{
+    //-----------------------------------------------------------------------------
+    struct pollfd pfd;
+    //-----------------------------------------------------------------------------
+
+    if(g_pty_rx_waiting)
+    {
+        return 1;
+    }
+
+    pfd.fd = g_pty_master;
+    pfd.events = POLLIN;
+    if(poll(&pfd, 1, UART_txPending() ? 0 : PTY_RX_POLL_MS) <= 0)
+    {
+        return 0;
+    }
+
+    if(read(g_pty_master, &g_pty_rx_char, 1) == 1)
+    {
+        g_pty_rx_waiting = 1;
+    }
+
+    return g_pty_rx_waiting;
+}
+//=============================================================================
+// Reads the character fetched by rxReady, a PTY has no framing or parity errors.
+static char pty_read()
+{
+    g_pty_rx_waiting = 0;
+    return g_pty_rx_char;
+}
+//=============================================================================
+// Returns 1 if the pseudo-terminal can take another character, 0 otherwise.
+static uint32_t pty_txReady()
+{
+    //-----------------------------------------------------------------------------
+    struct pollfd pfd;
+    //-----------------------------------------------------------------------------
+
+    pfd.fd = g_pty_master;
+    pfd.events = POLLOUT;
+    return (poll(&pfd, 1, 0) > 0) && (pfd.revents & POLLOUT);
+}
+//=============================================================================
+// Writes one character to the pseudo-terminal.
+static void pty_write(char c)
+{
+    // txReady said there is room, retry anyway in case the buffer filled up in between
+    while((write(g_pty_master, &c, 1) != 1) && ((errno == EAGAIN) || (errno == EINTR)))
+    {
+        ;
+    }
+}
+//=============================================================================
+// Characters are handed to the kernel by write, there is nothing left to wait for.
+static uint32_t pty_txDone()
+{
+    return 1;
+}
+//=============================================================================
+// A PTY has no receive errors to clear.
+static void pty_clearErrors()
+{
+}
+//=============================================================================
+// Linux pseudo-terminal backend
+const UART_backend_t g_UART_backend_pty =
+{
+    pty_init,
+    pty_reset,
+    pty_rxReady,
+    pty_read,
+    pty_txReady,
+    pty_write,
+    pty_txDone,
+    pty_clearErrors
+};
+//=============================================================================
+
+#endif // UART_HOST
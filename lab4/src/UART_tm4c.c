@@ -0,0 +1,447 @@
+/**
+ * ----------------------------------------------------------------------------
+ * UART_tm4c.c
+ * Description: TM4C129 register backend for the UART driver. The UART
+ * operates at 9600 baud, package length of 8 bits, no parity bit, one stop
+ * bit and operates in normal channel mode.
+ * ----------------------------------------------------------------------------
+ */
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Includes
+#include "../inc/UART_backend.h"
+#include "../inc/register_defines.h"
+
+#include "inc/tm4c129encpdt.h"
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Global variables
+uint32_t g_UART_base_used;
+// GPIO port and receive (Rx) pin of the UART in use, needed for auto-baud detection
+uint32_t g_UART_port_base_used;
+uint32_t g_UART_rx_pin;
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+//=============================================================================
+// Sets up the hardware module.
+// Baud rate is fixed at 9600 baud, according to lab specification.
+// Word length is set to 8 bits, according to lab specification.
+static void tm4c_init(uint32_t ui32Base)
+{
+    //-----------------------------------------------------------------------------
+    volatile uint32_t UART_module_bit = 0;
+    volatile uint32_t UART_port_bit = 0;
+    volatile uint32_t UART_pin_bits = 0;
+    volatile uint32_t UART_pin = 0;
+    volatile uint32_t temp_port_base;
+
+    volatile uint32_t *RCGCUART_pointer = (volatile uint32_t*)RCGCUART;
+    volatile uint32_t *RCGCGPIO_pointer = (volatile uint32_t*)RCGCGPIO;
+
+    volatile uint32_t *GPIOAFSEL_pointer;
+    volatile uint32_t *GPIODR2R_pointer;
+    volatile uint32_t *GPIOSLR_pointer;
+    volatile uint32_t *GPIOPCTL_pointer;
+    volatile uint32_t *GPIODEN_pointer;
+
+    volatile uint32_t *UARTCTL_pointer = (volatile uint32_t*)(ui32Base + UARTCTL);
+    volatile uint32_t *UARTIBRD_pointer = (volatile uint32_t*)(ui32Base + UARTIBRD);
+    volatile uint32_t *UARTFBRD_pointer = (volatile uint32_t*)(ui32Base + UARTFBRD);
+    volatile uint32_t *UARTLCRH_pointer = (volatile uint32_t*)(ui32Base + UARTLCRH);
+    volatile uint32_t *UARTCC_pointer = (volatile uint32_t*)(ui32Base + UARTCC);
+    //-----------------------------------------------------------------------------
+
+    //-----------------------------------------------------------------------------
+    // Setting the Universal Asynchronous Receiver/Transmitter Run Mode Clock Gating Control to the correct UART module
+    // And
+    // Which port to enable for different UARTs
+    switch(ui32Base)
+    {
+        // UART base 0
+        case UART_base_0 :
+            // UART module 0
+            UART_module_bit = 0;
+            // UART port A (Receive (Rx) and transmit (Tx))
+            UART_port_bit = 0;
+            // Set which GPIO Port base is to be used
+            temp_port_base = GPIO_Port_A_base;
+            // UART Receive (Rx) and transmit (Tx) for UART module 0 is on pin 0 and 1 (set bits 4 and 0)
+            UART_pin_bits = ((1 << 0) | (1 << 4));
+            UART_pin = ((1 << 0) | (1 << 1));
+            break;
+        // UART base 1
+        case UART_base_1 :
+            // UART module 1
+            UART_module_bit = 1;
+            // UART port B (Receive (Rx) and transmit (Tx))
+            UART_port_bit = 1;
+            // Set which GPIO Port base is to be used
+            temp_port_base = GPIO_Port_B_base;
+            // UART Receive (Rx) and transmit (Tx) for UART module 1 is on pin 0 and 1 (set bits 4 and 0)
+            UART_pin_bits = ((1 << 0) | (1 << 4));
+            UART_pin = ((1 << 0) | (1 << 1));
+            break;
+        // UART base 2
+        case UART_base_2 :
+            // UART module 2
+            UART_module_bit = 2;
+            // UART port A (Receive (Rx) and transmit (Tx))
+            UART_port_bit = 0;
+            // Set which GPIO Port base is to be used
+            temp_port_base = GPIO_Port_A_base;
+            // UART Receive (Rx) and transmit (Tx) for UART module 0 is on pin 6 and 7 (set bits 28 and 24)
+            UART_pin_bits = ((1 << 24) | (1 << 28));
+            UART_pin = ((1 << 6) | (1 << 7));
+            break;
+        // UART base 3
+        case UART_base_3 :
+            // UART module 3
+            UART_module_bit = 3;
+            // UART port A (Receive (Rx) and transmit (Tx))
+            UART_port_bit = 0;
+            // Set which GPIO Port base is to be used
+            temp_port_base = GPIO_Port_A_base;
+            // UART Receive (Rx) and transmit (Tx) for UART module 0 is on pin 4 and 5 (set bits 20 and 16)
+            UART_pin_bits = ((1 << 16) | (1 << 20));
+            UART_pin = ((1 << 4) | (1 << 5));
+            break;
+        // UART base 4
+        case UART_base_4 :
+            // UART module 4
+            UART_module_bit = 4;
+            // UART port A (Receive (Rx) and transmit (Tx))
+            UART_port_bit = 0;
+            // Set which GPIO Port base is to be used
+            temp_port_base = GPIO_Port_A_base;
+            // UART Receive (Rx) and transmit (Tx) for UART module 0 is on pin 2 and 3 (set bits 12 and 8)
+            UART_pin_bits = ((1 << 8) | (1 << 12));
+            UART_pin = ((1 << 2) | (1 << 3));
+            break;
+        // UART base 5
+        case UART_base_5 :
+            // UART module 5
+            UART_module_bit = 5;
+            // UART port C (Receive (Rx) and transmit (Tx))
+            UART_port_bit = 2;
+            // Set which GPIO Port base is to be used
+            temp_port_base = GPIO_Port_C_base;
+            // UART Receive (Rx) and transmit (Tx) for UART module 0 is on pin 6 and 7 (set bits 28 and 24)
+            UART_pin_bits = ((1 << 24) | (1 << 28));
+            UART_pin = ((1 << 6) | (1 << 7));
+            break;
+        // UART base 6
+        case UART_base_6 :
+            // UART module 6
+            UART_module_bit = 6;
+            // UART port P (Receive (Rx) and transmit (Tx))
+            UART_port_bit = 13;
+            // Set which GPIO Port base is to be used
+            temp_port_base = GPIO_Port_P_base;
+            // UART Receive (Rx) and transmit (Tx) for UART module 0 is on pin 0 and 1 (set bits 4 and 0)
+            UART_pin_bits = ((1 << 0) | (1 << 4));
+            UART_pin = ((1 << 0) | (1 << 1));
+            break;
+        // UART base 7
+        case UART_base_7 :
+            // UART module 7
+            UART_module_bit = 7;
+            // UART port C (Receive (Rx) and transmit (Tx))
+            UART_port_bit = 2;
+            // Set which GPIO Port base is to be used
+            temp_port_base = GPIO_Port_C_base;
+            // UART Receive (Rx) and transmit (Tx) for UART module 0 is on pin 4 and 5 (set bits 20 and 16)
+            UART_pin_bits = ((1 << 16) | (1 << 20));
+            UART_pin = ((1 << 4) | (1 << 5));
+            break;
+        // Default is assuming UART base 0
+        default :
+            // UART module 0
+            UART_module_bit = 0;
+            // UART port A (Receive (Rx) and transmit (Tx))
+            UART_port_bit = 0;
+            // Set which GPIO Port base is to be used
+            temp_port_base = GPIO_Port_A_base;
+            // UART Receive (Rx) and transmit (Tx) for UART module 0 is on pin 0 and 1 (set bit 0 and 4)
+            UART_pin_bits = ((1 << 0) | (1 << 4));
+            UART_pin = ((1 << 0) | (1 << 1));
+            break;
+    }
+
+    // Set various register pointers to the correct address given the UART module and port
+    GPIOAFSEL_pointer = (volatile uint32_t*) (temp_port_base + GPIOAFSEL);
+    GPIODR2R_pointer = (volatile uint32_t*) (temp_port_base + GPIODR2R);
+    GPIOSLR_pointer = (volatile uint32_t*) (temp_port_base + GPIOSLR);
+    GPIOPCTL_pointer = (volatile uint32_t*) (temp_port_base + GPIOPCTL);
+    GPIODEN_pointer = (volatile uint32_t*) (temp_port_base + GPIODEN);
+    //-----------------------------------------------------------------------------
+
+    //-----------------------------------------------------------------------------
+    /* Enable UART register access */
+    // Setting the UART_module_bit bit to 1 and thus enabling and providing a clock to UART module UART_module_bit in Run mode.
+    *RCGCUART_pointer |= (1 << UART_module_bit);
+    // Enable port corresponding to the UART module to run
+    *RCGCGPIO_pointer |= (1 << UART_port_bit);
+
+    //-----------------------------------------------------------------------------
+    /* Disable UART */
+    // Clear UARTEN bit (bit 0). Disabling UART for configuration
+    *UARTCTL_pointer &= ~(1 << 0);
+
+    //-----------------------------------------------------------------------------
+    /* Enable UART receive and transmit */
+    // The transmit section of the UART is enabled (bit 8). The receive section of the UART is enabled (bit 9)
+    *UARTCTL_pointer |= ((1 << 8) | (1 << 9));
+
+    //-----------------------------------------------------------------------------
+    /* Enable pins for UART */
+    // Mode control select register for the corresponding pins
+    *GPIOAFSEL_pointer |= UART_pin;
+    // Enable the digital functions for the corresponding pins. (According to lab instruction hints)
+    *GPIODEN_pointer |= UART_pin;
+    // Assign the UART signals to the appropriate pins
+    *GPIOPCTL_pointer |= UART_pin_bits;
+
+    //-----------------------------------------------------------------------------
+    /* Baud rate */
+    // Set the integer part to 9600 baud rate
+    // Default system clock runs at 16Mhz, page 1966
+    // BRD = 16,000,000 / (16 * 9,600) = 104.166667
+    *UARTIBRD_pointer = 104;
+    // Set the fractional part (104.166667 - 104 = 0.166667) to 9600 baud rate
+    // UARTFBRD[DIVFRAC] = integer(0.166667 * 64 + 0.5) = 11
+    *UARTFBRD_pointer = 11;
+
+    //-----------------------------------------------------------------------------
+    /* FIFO, stop bit, parity, word length */
+    // Disable FIFO
+    *UARTLCRH_pointer &= ~(1 << 4);
+    // One stop bit (clearing bit 3)
+    *UARTLCRH_pointer &= ~(1 << 3);
+    // No parity (clearing bit 1)
+    *UARTLCRH_pointer &= ~(1 << 1);
+    // Set word length to 8 (by setting bits 5 and 6 to 1) (also necessary to write to this register for the baud rate changes to take effect)
+    *UARTLCRH_pointer |= ((1 << 5) | (1 << 6));
+
+    // Configure the UART clock source, clear the first 4 bits (3 to 0) to set it to normal system clock
+    // Use default system clock which runs at 16Mhz, page 1966
+    *UARTCC_pointer &= ~(0xF);
+
+    //-----------------------------------------------------------------------------
+    /* Current and slew rate mode */
+    // Do not need to enable 2-mA mode since this is default
+    //*GPIODR2R_pointer |= (1 << 0);
+    // Slew Rate Limit Enable (control), need not be enabled since it is not available for 2-mA mode.
+    //*GPIOSLR_pointer |= (1 << 0);
+
+    //-----------------------------------------------------------------------------
+    /* Mode select */
+    // Run in normal (channel?) mode
+    //
+    *UARTCTL_pointer &= ~(1 << 1);
+    //
+    *UARTCTL_pointer &= ~(1 << 3);
+    //
+    *UARTCTL_pointer &= ~(1 << 7);
+
+    //-----------------------------------------------------------------------------
+    /* Enable UART */
+    // Enable UARTEN bit (bit 0).
+    *UARTCTL_pointer |= ((1 << 0));
+
+    //-----------------------------------------------------------------------------
+    /* Setting global variables */
+    // Set a global variable to the base that is to be used, since getChar etc needs to know which base to operate from (We cannot pass it as an argument since we must follow the API given)
+    g_UART_base_used = ui32Base;
+    // Remember the port and the Rx pin, Rx is always the lower of the two pins
+    g_UART_port_base_used = temp_port_base;
+    g_UART_rx_pin = UART_pin & (~UART_pin + 1);
+    //-----------------------------------------------------------------------------
+}
+//=============================================================================
+// Returns 1 if a received character is waiting, 0 otherwise.
+static uint32_t tm4c_rxReady()
+{
+    //-----------------------------------------------------------------------------
+    volatile uint32_t *UARTFR_pointer = (volatile uint32_t*) (g_UART_base_used + UARTFR);
+    //-----------------------------------------------------------------------------
+
+    // This bit (4) is cleared when the receiver isn't empty
+    return !((*UARTFR_pointer) & (1 << 4));
+}
+//=============================================================================
+// Reads the received character, or an error code (129-132) if there was an error with the data received.
+static char tm4c_read()
+{
+    //-----------------------------------------------------------------------------
+    volatile uint32_t *UARTDR_pointer = (volatile uint32_t*) (g_UART_base_used + UARTDR);
+    volatile uint32_t *UARTRSR_ECR_pointer = (volatile uint32_t*) (g_UART_base_used + UARTRSR_ECR);
+
+    volatile char character_received;
+    //-----------------------------------------------------------------------------
+
+    // Read the bits received, binary form
+    character_received = (char) (*UARTDR_pointer & 0xFF);
+
+    //-----------------------------------------------------------------------------
+    // Check if there was any errors with the data received.
+    // (Note that we read this from UARTRSR/UARTECR rather than UARTDR since UARTDR is read-sensitive, so once UARTDR is read, the content in UARTDR is expected to be altered!)
+    // UART Framing Error
+    if ((*UARTRSR_ECR_pointer) & (1 << 0))
+    {
+        // Clear the error register once it's been noticed
+        *UARTRSR_ECR_pointer = 0x00000000;
+        // Return value if there was an error with the data received
+        // 129 is not a defined ASCII symbol
+        return (char) 129;
+    }
+    // UART Parity Error
+    if ((*UARTRSR_ECR_pointer) & (1 << 1))
+    {
+        // Clear the error register once it's been noticed
+        *UARTRSR_ECR_pointer = 0x00000000;
+        // Return value if there was an error with the data received
+        // 130 is not a defined ASCII symbol
+        return (char) 130;
+    }
+    // UART Break Error
+    if ((*UARTRSR_ECR_pointer) & (1 << 2))
+    {
+        // Clear the error register once it's been noticed
+        *UARTRSR_ECR_pointer = 0x00000000;
+        // Return value if there was an error with the data received
+        // 131 is not a defined ASCII symbol
+        return (char) 131;
+    }
+    // UART Overrun Error
+    if ((*UARTRSR_ECR_pointer) & (1 << 3))
+    {
+        // Clear the error register once it's been noticed
+        *UARTRSR_ECR_pointer = 0x00000000;
+        // Return value if there was an error with the data received
+        // 132 is not a defined ASCII symbol
+        return (char) 132;
+    }
+    //-----------------------------------------------------------------------------
+
+    // Return the character received
+    return character_received;
+}
+//=============================================================================
+// Returns 1 if the transmitter can take another character, 0 otherwise.
+static uint32_t tm4c_txReady()
+{
+    //-----------------------------------------------------------------------------
+    volatile uint32_t *UARTFR_pointer = (volatile uint32_t*) (g_UART_base_used + UARTFR);
+    //-----------------------------------------------------------------------------
+
+    // This bit (5) is cleared when the transmitter isn't full
+    return !((*UARTFR_pointer) & (1 << 5));
+}
+//=============================================================================
+// Writes one character to the transmitter.
+static void tm4c_write(char c)
+{
+    //-----------------------------------------------------------------------------
+    volatile uint32_t *UARTDR_pointer = (volatile uint32_t*) (g_UART_base_used + UARTDR);
+    //-----------------------------------------------------------------------------
+
+    // Write the data that is to be transmitted into the data field
+    *UARTDR_pointer = c;
+}
+//=============================================================================
+// Returns 1 once every written character has been sent, 0 otherwise.
+static uint32_t tm4c_txDone()
+{
+    //-----------------------------------------------------------------------------
+    volatile uint32_t *UARTFR_pointer = (volatile uint32_t*) (g_UART_base_used + UARTFR);
+    //-----------------------------------------------------------------------------
+
+    // The transmit holding register is empty (bit 7 set) and the UART is no longer busy (bit 3 cleared)
+    return ((*UARTFR_pointer) & (1 << 7)) && !((*UARTFR_pointer) & (1 << 3));
+}
+//=============================================================================
+// Clears the receive errors latched in UARTRSR/UARTECR.
+static void tm4c_clearErrors()
+{
+    //-----------------------------------------------------------------------------
+    volatile uint32_t *UARTRSR_ECR_pointer = (volatile uint32_t*) (g_UART_base_used + UARTRSR_ECR);
+    //-----------------------------------------------------------------------------
+
+    // Any write clears the framing, parity, break and overrun errors
+    *UARTRSR_ECR_pointer = 0x00000000;
+}
+//=============================================================================
+// Resets every UART register (for all UARTs) to its reset value.
+static void tm4c_reset()
+{
+    //-----------------------------------------------------------------------------
+    volatile uint32_t i = 0;
+    volatile uint32_t j = 0;
+    // Pointer for accessing registers
+    volatile uint32_t *temp_pointer;
+
+    // These need to be set and enabled to reset UART registers
+    volatile uint32_t *RCGCUART_pointer = (volatile uint32_t*) RCGCUART;
+    volatile uint32_t *RCGCGPIO_pointer = (volatile uint32_t*) RCGCGPIO;
+
+    // Array containing every UART base
+    volatile uint32_t base_arr[8] = {UART_base_0, UART_base_1, UART_base_2, UART_base_3, UART_base_4, UART_base_5, UART_base_6, UART_base_7};
+    // Array containing the offset for all 30 UART registers
+    volatile uint32_t register_arr[30] = {
+                               UARTDR       , UARTRSR_ECR  , UARTFR       , UARTILPR     , UARTIBRD     , UARTFBRD     , UARTLCRH    , UARTCTL     , UARTIFLS     , UARTIM       ,
+                               UARTRIS      , UARTMIS      , UARTICR      , UARTDMACTL   , UART9BITADDR , UART9BITAMASK, UARTPP      , UARTCC      , UARTPeriphID4, UARTPeriphID5,
+                               UARTPeriphID6, UARTPeriphID7, UARTPeriphID0, UARTPeriphID1, UARTPeriphID2, UARTPeriphID3, UARTPCellID0, UARTPCellID1, UARTPCellID2 , UARTPCellID3
+                               };
+    // Array containing the reset vector for all 30 UART registers
+    volatile uint32_t reset_arr[30] = {
+                            0x00000000, 0x00000000, 0x00000090, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000300, 0x00000012, 0x00000000,
+                            0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x000000FF, 0x0000000F, 0x00000000, 0x00000060, 0x00000000,
+                            0x00000000, 0x00000000, 0x00000011, 0x00000000, 0x00000018, 0x00000001, 0x0000000D, 0x000000F0, 0x00000005, 0x000000B1
+                            };
+    //-----------------------------------------------------------------------------
+
+    //-----------------------------------------------------------------------------
+    // Enabling all UART bases, this is vital, otherwise trying to reset any UART register will result in a fault interrupt and the program will get stuck in a while loop in the faultISR forever
+    // Enabling and providing a clock to all UART modules and enabling them in Run mode.
+    *RCGCUART_pointer = 0xFF;
+    // Enable all ports
+    *RCGCGPIO_pointer = 0x7FFF;
+    //-----------------------------------------------------------------------------
+    // Using the respective reset vector to reset every UART register (for all UARTs)
+    // Loop over every UART base since we need to reset all of them
+
+    for(i = 0; i < 8; i++)
+    {
+        // Loop over every UART register to reset all of them
+        for(j = 0; j < 30; j++)
+        {
+            // Set pointer to the base + register
+            temp_pointer = (uint32_t*)(base_arr[i] + register_arr[j]);
+            // Reset that base + register
+            *temp_pointer = reset_arr[j];
+        }
+    }
+
+    //-----------------------------------------------------------------------------
+    // Disable all the UART bases again
+    // Clearing the UART_module_bit bit and thus disabling the UART module.
+    *RCGCUART_pointer = 0x00000000;
+    // Disable the port
+    *RCGCGPIO_pointer = 0x00000000;
+    //-----------------------------------------------------------------------------
+}
+//=============================================================================
+// TM4C129 register backend
+const UART_backend_t g_UART_backend_tm4c =
+{
+    tm4c_init,
+    tm4c_reset,
+    tm4c_rxReady,
+    tm4c_read,
+    tm4c_txReady,
+    tm4c_write,
+    tm4c_txDone,
+    tm4c_clearErrors
+};
+//=============================================================================
@@ -0,0 +1,320 @@
+/**
+ * ----------------------------------------------------------------------------
+ * UART_trace.c
+ * Description: UART receive latency tracing c file. Timestamps are taken
+ * from the DWT cycle counter (running at the system clock) on target and from
+ * a simulated cycle counter on the host. Every latency channel keeps a
+ * histogram with four linear buckets per power of two, from which
+ * min/avg/p99/max can be read.
+ * ----------------------------------------------------------------------------
+ */
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Includes
+#include "../inc/UART_trace.h"
+#include "../inc/UART_driver.h"
+#include "../inc/register_defines.h"
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+// Values 0-3 get one bucket each, then 4 buckets per power of two up to bit 31
+#define TRACE_BUCKETS 124
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Global variables
+// Set by UART_getChar, cycle count when the driver saw the last byte in the receiver
+extern uint32_t g_uart_rx_ready_stamp;
+// Set by UART_getChar, 1 if the last byte was already waiting when it was called
+extern uint32_t g_uart_rx_waiting_on_entry;
+extern uint32_t g_uart_trace_enabled;
+extern uint32_t g_uart_init;
+
+uint32_t g_trace_count[UART_TRACE_CHANNELS];
+uint32_t g_trace_min[UART_TRACE_CHANNELS];
+uint32_t g_trace_max[UART_TRACE_CHANNELS];
+uint64_t g_trace_sum[UART_TRACE_CHANNELS];
+uint32_t g_trace_hist[UART_TRACE_CHANNELS][TRACE_BUCKETS];
+// Bytes that were already waiting when UART_getChar was called, cleared with the UART_TRACE_RX_DRIVER statistics
+uint32_t g_trace_rx_waiting = 0;
+#ifdef UART_HOST
+uint32_t g_trace_sim_cycles = 0;
+#endif
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+//=============================================================================
+// Returns the histogram bucket a value belongs to.
+static uint32_t trace_bucket(uint32_t value)
+{
+    //-----------------------------------------------------------------------------
+    uint32_t msb = 31;
+    //-----------------------------------------------------------------------------
+
+    if(value < 4)
+    {
+        return value;
+    }
+
+    // Find the most significant bit set
+    while(!(value & (1UL << msb)))
+    {
+        msb--;
+    }
+
+    // 4 buckets per power of two, selected by the two bits below the most significant bit
+    return ((msb - 1) * 4) + ((value >> (msb - 2)) & 0x3);
+}
+//=============================================================================
+// Returns the largest value that falls in a histogram bucket.
+static uint32_t trace_bucket_upper(uint32_t bucket)
+{
+    //-----------------------------------------------------------------------------
+    uint32_t msb = (bucket / 4) + 1;
+    uint32_t sub = bucket % 4;
+    //-----------------------------------------------------------------------------
+
+    if(bucket < 4)
+    {
+        return bucket;
+    }
+
+    // Last bucket ends at the largest 32 bit value
+    if(bucket == (TRACE_BUCKETS - 1))
+    {
+        return 0xFFFFFFFF;
+    }
+
+    return ((4 + sub + 1) << (msb - 2)) - 1;
+}
+//=============================================================================
+// This function enables the cycle counter and the timestamped receive path, all statistics are cleared.
+void UART_trace_init()
+{
+    //-----------------------------------------------------------------------------
+    uint32_t i = 0;
+    //-----------------------------------------------------------------------------
+
+    UART_trace_startCounter();
+#ifdef UART_HOST
+    // The simulated counter starts from 0 every time
+    g_trace_sim_cycles = 0;
+#endif
+
+    for(i = 0; i < UART_TRACE_CHANNELS; i++)
+    {
+        UART_trace_resetStats(i);
+    }
+
+    // UART_getChar will now stamp every received byte
+    g_uart_trace_enabled = 1;
+}
+//=============================================================================
+// This function starts the cycle counter if it isn't running, the statistics are not touched.
+void UART_trace_startCounter()
+{
+#ifndef UART_HOST
+    //-----------------------------------------------------------------------------
+    volatile uint32_t *DEMCR_pointer = (volatile uint32_t*) DEMCR;
+    volatile uint32_t *DWT_CTRL_pointer = (volatile uint32_t*) DWT_CTRL;
+    volatile uint32_t *DWT_CYCCNT_pointer = (volatile uint32_t*) DWT_CYCCNT;
+    //-----------------------------------------------------------------------------
+
+    // Enable the trace unit (TRCENA, bit 24), otherwise the DWT registers can not be accessed
+    *DEMCR_pointer |= (1 << 24);
+    // Only start from 0 the first time, restarting would break stamps already taken
+    if(!((*DWT_CTRL_pointer) & (1 << 0)))
+    {
+        *DWT_CYCCNT_pointer = 0;
+        // Enable the cycle counter (CYCCNTENA, bit 0)
+        *DWT_CTRL_pointer |= (1 << 0);
+    }
+#endif
+}
+//=============================================================================
+// This function returns the current cycle count.
+// The counter wraps after 2^32 cycles (about 268 seconds at 16Mhz), differences are taken with unsigned arithmetic so one wrap is handled.
+uint32_t UART_trace_now()
+{
+#ifndef UART_HOST
+    return *((volatile uint32_t*) DWT_CYCCNT);
+#else
+    return g_trace_sim_cycles;
+#endif
+}
+//=============================================================================
+// This function receives one character and stores the cycle count when it was read by the driver in rx_stamp.
+char UART_getCharStamped(uint32_t *rx_stamp)
+{
+    //-----------------------------------------------------------------------------
+    char character_received;
+    //-----------------------------------------------------------------------------
+
+    character_received = UART_getChar();
+    *rx_stamp = UART_trace_now();
+
+    // Time spent in the driver from seeing the byte until it is handed over
+    // The ready stamp is only taken when tracing is enabled and the driver actually received something
+    if((g_uart_trace_enabled == 1) && (g_uart_init == 1))
+    {
+        UART_trace_record(UART_TRACE_RX_DRIVER, *rx_stamp - g_uart_rx_ready_stamp);
+
+        // How long such a byte waited is unknown, but how often it happens shows the application falling behind
+        if(g_uart_rx_waiting_on_entry == 1)
+        {
+            g_trace_rx_waiting++;
+        }
+    }
+
+    return character_received;
+}
+//=============================================================================
+// This function receives a string and stores the cycle count when the line terminator was read by the driver in rx_stamp.
+// Same behavior as UART_getString.
+void UART_getStringStamped(char *buffer, uint32_t *rx_stamp)
+{
+    //-----------------------------------------------------------------------------
+    int idx = 0;
+    uint32_t first_ready_stamp = 0;
+    //-----------------------------------------------------------------------------
+
+    // Continue to read as long as there is data that can be received.
+    while(idx < (BUFF_LEN-1))
+    {
+        // Get one character at a time
+        buffer[idx] = UART_getCharStamped(rx_stamp);
+        // Remember when the line started arriving
+        if(idx == 0)
+        {
+            first_ready_stamp = g_uart_rx_ready_stamp;
+        }
+        // Break early if we find end of string
+        if ((buffer[idx] == '\n') || (buffer[idx] == '\r'))
+        {
+            break;
+        }
+        idx++;
+    }
+
+    // Null-terminate the string
+    buffer[idx] = '\0';
+
+    // Time from the driver seeing the first byte until the whole line has been read
+    // Same as for single characters, the ready stamp is stale unless tracing is enabled and the driver is initialized
+    if((g_uart_trace_enabled == 1) && (g_uart_init == 1))
+    {
+        UART_trace_record(UART_TRACE_LINE_ASSEMBLY, *rx_stamp - first_ready_stamp);
+    }
+}
+//=============================================================================
+// This function is called by the application when it consumes a byte or line, rx_stamp is the stamp from the receive function.
+// Channel should be UART_TRACE_RX_APP for bytes and UART_TRACE_LINE_APP for lines.
+void UART_trace_consumed(uint32_t channel, uint32_t rx_stamp)
+{
+    UART_trace_record(channel, UART_trace_now() - rx_stamp);
+}
+//=============================================================================
+// This function returns how many traced bytes were already waiting in the receiver when UART_getChar was called.
+uint32_t UART_trace_rxWaiting()
+{
+    return g_trace_rx_waiting;
+}
+//=============================================================================
+// This function records one latency sample (in cycles) into the histogram of a channel.
+void UART_trace_record(uint32_t channel, uint32_t cycles)
+{
+    // Ignore channels that do not exist
+    if(channel >= UART_TRACE_CHANNELS)
+    {
+        return;
+    }
+
+    if((g_trace_count[channel] == 0) || (cycles < g_trace_min[channel]))
+    {
+        g_trace_min[channel] = cycles;
+    }
+    if(cycles > g_trace_max[channel])
+    {
+        g_trace_max[channel] = cycles;
+    }
+    g_trace_sum[channel] += cycles;
+    g_trace_count[channel]++;
+    g_trace_hist[channel][trace_bucket(cycles)]++;
+}
+//=============================================================================
+// This function reads the latency statistics of a channel.
+// All values are 0 if nothing has been recorded.
+void UART_trace_getStats(uint32_t channel, UART_latency_t *stats)
+{
+    //-----------------------------------------------------------------------------
+    uint32_t i = 0;
+    uint32_t seen = 0;
+    uint32_t rank = 0;
+    //-----------------------------------------------------------------------------
+
+    stats->count = 0;
+    stats->min = 0;
+    stats->avg = 0;
+    stats->p99 = 0;
+    stats->max = 0;
+
+    if((channel >= UART_TRACE_CHANNELS) || (g_trace_count[channel] == 0))
+    {
+        return;
+    }
+
+    stats->count = g_trace_count[channel];
+    stats->min = g_trace_min[channel];
+    stats->avg = (uint32_t) (g_trace_sum[channel] / g_trace_count[channel]);
+    stats->max = g_trace_max[channel];
+
+    // The 99th percentile is the sample at rank count - count/100 (counting from 1)
+    rank = stats->count - (stats->count / 100);
+    for(i = 0; i < TRACE_BUCKETS; i++)
+    {
+        seen += g_trace_hist[channel][i];
+        if(seen >= rank)
+        {
+            stats->p99 = trace_bucket_upper(i);
+            break;
+        }
+    }
+
+    // The bucket bound can not be larger than the largest sample
+    if(stats->p99 > stats->max)
+    {
+        stats->p99 = stats->max;
+    }
+}
+//=============================================================================
+// This function clears the statistics of a channel.
+void UART_trace_resetStats(uint32_t channel)
+{
+    //-----------------------------------------------------------------------------
+    uint32_t i = 0;
+    //-----------------------------------------------------------------------------
+
+    if(channel >= UART_TRACE_CHANNELS)
+    {
+        return;
+    }
+
+    g_trace_count[channel] = 0;
+    g_trace_min[channel] = 0;
+    g_trace_max[channel] = 0;
+    g_trace_sum[channel] = 0;
+    for(i = 0; i < TRACE_BUCKETS; i++)
+    {
+        g_trace_hist[channel][i] = 0;
+    }
+    if(channel == UART_TRACE_RX_DRIVER)
+    {
+        g_trace_rx_waiting = 0;
+    }
+}
+//=============================================================================
+#ifdef UART_HOST
+// This function advances the simulated cycle counter used instead of DWT on the host.
+void UART_trace_simAdvance(uint32_t cycles)
+{
+    g_trace_sim_cycles += cycles;
+}
+#endif
+//=============================================================================
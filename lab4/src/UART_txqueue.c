@@ -0,0 +1,288 @@
+/**
+ * ----------------------------------------------------------------------------
+ * UART_txqueue.c
+ * Description: UART priority transmit queue c file. Frames are queued per
+ * priority class and written one byte at a time by UART_txService. A new
+ * frame is only picked at a frame boundary, the highest priority class with a
+ * queued frame goes first, so an urgent frame waits for at most the rest of
+ * the frame currently being sent (UART_TX_FRAME_MAX bytes, about 34ms at
+ * 9600 baud) instead of the whole bulk transfer. There is no transmit
+ * interrupt, bytes only move while the application is inside a driver routine
+ * that services the queue, so a frame queued from an interrupt handler while
+ * the application runs its own code waits for the next such call.
+ * ----------------------------------------------------------------------------
+ */
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Includes
+#include "../inc/UART_txqueue.h"
+#include "../inc/UART_backend.h"
+#include "../inc/UART_trace.h"
+#include "../inc/register_defines.h"
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+// No frame is being sent
+#define TXQ_NONE 0xFFFFFFFF
+
+// Frames may be queued from interrupt handlers, so the queue bookkeeping is done with interrupts masked.
+// PRIMASK is saved on entry and restored on exit, so callers that already masked interrupts keep them masked.
+#ifndef UART_HOST
+#define TXQ_ENTER_CRITICAL(primask) ((primask) = txq_mask_interrupts())
+#define TXQ_EXIT_CRITICAL(primask) txq_restore_interrupts(primask)
+#else
+#define TXQ_ENTER_CRITICAL(primask) ((primask) = 0)
+#define TXQ_EXIT_CRITICAL(primask) ((void) (primask))
+#endif
+
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+// Global variables
+extern const UART_backend_t *g_UART_backend;
+extern uint32_t g_uart_init;
+extern uint32_t g_uart_trace_enabled;
+
+// Frame storage, one ring of slots per priority class
+char g_txq_data[UART_PRIO_CLASSES][UART_TX_SLOTS][UART_TX_FRAME_MAX];
+uint32_t g_txq_len[UART_PRIO_CLASSES][UART_TX_SLOTS];
+// Cycle count when each frame was queued, only valid if the frame was stamped (tracing was enabled when it was queued)
+uint32_t g_txq_stamp[UART_PRIO_CLASSES][UART_TX_SLOTS];
+uint32_t g_txq_stamped[UART_PRIO_CLASSES][UART_TX_SLOTS];
+// Oldest queued slot, next free slot and number of queued frames per class
+volatile uint32_t g_txq_head[UART_PRIO_CLASSES];
+volatile uint32_t g_txq_tail[UART_PRIO_CLASSES];
+volatile uint32_t g_txq_count[UART_PRIO_CLASSES];
+// Class of the frame currently being sent (its head slot) and the next byte to send from it
+uint32_t g_txq_active = TXQ_NONE;
+uint32_t g_txq_active_idx = 0;
+//+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+
+//=============================================================================
+#ifndef UART_HOST
+// Masks interrupts and returns the previous PRIMASK.
+static uint32_t txq_mask_interrupts()
+{
+#if defined(__TI_COMPILER_VERSION__)
+    return _disable_IRQ();
+#else
+    //-----------------------------------------------------------------------------
+    uint32_t primask;
+    //-----------------------------------------------------------------------------
+
+    __asm volatile (" mrs %0, primask\n cpsid i" : "=r" (primask) : : "memory");
+    return primask;
+#endif
+}
+//=============================================================================
+// Restores PRIMASK saved by txq_mask_interrupts.
+static void txq_restore_interrupts(uint32_t primask)
+{
+#if defined(__TI_COMPILER_VERSION__)
+    _restore_interrupts(primask);
+#else
+    __asm volatile (" msr primask, %0" : : "r" (primask) : "memory");
+#endif
+}
+#endif
+//=============================================================================
+// This function queues one frame of length bytes in a priority class. Returns 1 if queued, 0 if the class is full or the frame too long.
+// May be called from an interrupt handler, the frame is sent by the next driver routine that services the queue.
+uint32_t UART_txQueue(const char *frame, uint32_t length, uint32_t prio)
+{
+    //-----------------------------------------------------------------------------
+    uint32_t i = 0;
+    uint32_t slot = 0;
+    uint32_t primask = 0;
+    //-----------------------------------------------------------------------------
+
+    if((prio >= UART_PRIO_CLASSES) || (length == 0) || (length > UART_TX_FRAME_MAX))
+    {
+        return 0;
+    }
+
+    TXQ_ENTER_CRITICAL(primask);
+
+    // No room in this class
+    if(g_txq_count[prio] >= UART_TX_SLOTS)
+    {
+        TXQ_EXIT_CRITICAL(primask);
+        return 0;
+    }
+
+    // Copy the frame into the next free slot, the slot being sent (head) is never the free one
+    slot = g_txq_tail[prio];
+    for(i = 0; i < length; i++)
+    {
+        g_txq_data[prio][slot][i] = frame[i];
+    }
+    g_txq_len[prio][slot] = length;
+    g_txq_stamped[prio][slot] = g_uart_trace_enabled;
+    if(g_uart_trace_enabled == 1)
+    {
+        g_txq_stamp[prio][slot] = UART_trace_now();
+    }
+
+    g_txq_tail[prio] = (slot + 1) % UART_TX_SLOTS;
+    g_txq_count[prio]++;
+
+    TXQ_EXIT_CRITICAL(primask);
+
+    return 1;
+}
+//=============================================================================
+// This function writes the next queued byte if the transmitter has room, it never blocks. Must not be called from an interrupt handler.
+void UART_txService()
+{
+    //-----------------------------------------------------------------------------
+    uint32_t prio = 0;
+    uint32_t slot = 0;
+    uint32_t primask = 0;
+    //-----------------------------------------------------------------------------
+
+    // Will not try to access the hardware if the driver hasn't been initialized
+    if(g_uart_init == 0)
+    {
+        return;
+    }
+
+    // Transmitter is full, try again later
+    if(!g_UART_backend->txReady())
+    {
+        return;
+    }
+
+    // At a frame boundary, pick the oldest frame of the highest priority class that has one
+    if(g_txq_active == TXQ_NONE)
+    {
+        TXQ_ENTER_CRITICAL(primask);
+        for(prio = 0; prio < UART_PRIO_CLASSES; prio++)
+        {
+            if(g_txq_count[prio] > 0)
+            {
+                g_txq_active = prio;
+                g_txq_active_idx = 0;
+                break;
+            }
+        }
+        TXQ_EXIT_CRITICAL(primask);
+
+        // Nothing queued
+        if(g_txq_active == TXQ_NONE)
+        {
+            return;
+        }
+
+        // Time the frame spent queued, frames queued before tracing was enabled have no stamp
+        slot = g_txq_head[g_txq_active];
+        if((g_uart_trace_enabled == 1) && (g_txq_stamped[g_txq_active][slot] == 1))
+        {
+            UART_trace_record(UART_TRACE_TX_HIGH + g_txq_active, UART_trace_now() - g_txq_stamp[g_txq_active][slot]);
+        }
+    }
+
+    // Write the next byte of the active frame
+    slot = g_txq_head[g_txq_active];
+    g_UART_backend->write(g_txq_data[g_txq_active][slot][g_txq_active_idx]);
+    g_txq_active_idx++;
+
+    // Whole frame written, free its slot
+    if(g_txq_active_idx >= g_txq_len[g_txq_active][slot])
+    {
+        TXQ_ENTER_CRITICAL(primask);
+        g_txq_head[g_txq_active] = (slot + 1) % UART_TX_SLOTS;
+        g_txq_count[g_txq_active]--;
+        TXQ_EXIT_CRITICAL(primask);
+
+        g_txq_active = TXQ_NONE;
+    }
+}
+//=============================================================================
+// This function services the queue until every queued frame has been written.
+void UART_txFlush()
+{
+    // Nothing can be sent if the driver hasn't been initialized
+    if(g_uart_init == 0)
+    {
+        return;
+    }
+
+    while(UART_txPending())
+    {
+        UART_txService();
+    }
+}
+//=============================================================================
+// This function returns 1 if there are frames left to send, 0 otherwise.
+uint32_t UART_txPending()
+{
+    //-----------------------------------------------------------------------------
+    uint32_t prio = 0;
+    //-----------------------------------------------------------------------------
+
+    if(g_txq_active != TXQ_NONE)
+    {
+        return 1;
+    }
+
+    for(prio = 0; prio < UART_PRIO_CLASSES; prio++)
+    {
+        if(g_txq_count[prio] > 0)
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+//=============================================================================
+// This function drops every queued frame.
+void UART_txReset()
+{
+    //-----------------------------------------------------------------------------
+    uint32_t prio = 0;
+    uint32_t primask = 0;
+    //-----------------------------------------------------------------------------
+
+    TXQ_ENTER_CRITICAL(primask);
+    for(prio = 0; prio < UART_PRIO_CLASSES; prio++)
+    {
+        g_txq_head[prio] = 0;
+        g_txq_tail[prio] = 0;
+        g_txq_count[prio] = 0;
+    }
+    g_txq_active = TXQ_NONE;
+    g_txq_active_idx = 0;
+    TXQ_EXIT_CRITICAL(primask);
+}
+//=============================================================================
+// This function splits a string into frames and queues them in a priority class, waiting for room when the class is full.
+// Frames are UART_TX_FRAME_MAX bytes, except the last one.
+void UART_putStringPrio(char *string, uint32_t prio)
+{
+    //-----------------------------------------------------------------------------
+    uint32_t idx = 0;
+    uint32_t length = 0;
+    //-----------------------------------------------------------------------------
+
+    // Frames can never be sent if the driver hasn't been initialized, do not wait for room
+    if((g_uart_init == 0) || (prio >= UART_PRIO_CLASSES))
+    {
+        return;
+    }
+
+    // Queue until end of string \0 is found
+    while(string[idx])
+    {
+        length = 0;
+        while((length < UART_TX_FRAME_MAX) && string[idx + length])
+        {
+            length++;
+        }
+
+        // Keep the transmitter busy while waiting for a free slot
+        while(!UART_txQueue(&string[idx], length, prio))
+        {
+            UART_txService();
+        }
+        idx += length;
+    }
+}
+//=============================================================================